@@ -4,6 +4,7 @@
 #include <string>
 #include <map>
 #include <algine/types.h>
+#include <algine/AssetPack.h>
 
 namespace algine {
 class AMTLLoader {
@@ -44,6 +45,12 @@ public:
 
     bool load(const std::string &path);
 
+    // loads AMTL entry `name` from the `pack`
+    bool load(const AssetPack &pack, const std::string &name);
+
+    // parses AMTL JSON string
+    bool parse(const std::string &str);
+
 public:
     std::map<std::string, MaterialObject> m_materials; // name, MaterialObject
 };
@@ -0,0 +1,54 @@
+#ifndef ALGINE_ANIMATIONBATCH_H
+#define ALGINE_ANIMATIONBATCH_H
+
+#include <algine/model.h>
+#include <algine/ThreadPool.h>
+#include <vector>
+#include <future>
+
+namespace algine {
+/**
+ * Evaluates poses of many models on the thread pool, one task per model.
+ * Poses are written to `Model::backPalette` and become visible after the
+ * evaluation is finished, so rendering of the current poses can overlap with
+ * evaluation of the next ones. Each model must have own `Animator`, since
+ * animators keep per-instance state
+ */
+class AnimationBatch {
+public:
+    explicit AnimationBatch(ThreadPool *pool = ThreadPool::getDefault());
+    ~AnimationBatch();
+
+    AnimationBatch(const AnimationBatch &src) = delete;
+    AnimationBatch& operator=(const AnimationBatch &rhs) = delete;
+
+    // models without animator are skipped
+    void add(Model *model);
+    void remove(Model *model);
+    void clear();
+
+    /**
+     * Starts evaluation of all models. Models, their animators and shapes
+     * must not be changed until `finish`
+     */
+    void begin(float timeInSeconds);
+
+    /**
+     * Waits for the started evaluation, executing its tasks on the calling thread
+     * meanwhile, then swaps palettes. Does nothing if evaluation isn't started
+     */
+    void finish();
+
+    // begin & finish
+    void animate(float timeInSeconds);
+
+    bool isRunning() const;
+
+protected:
+    ThreadPool *m_pool;
+    std::vector<Model*> m_models;
+    std::vector<std::future<void>> m_tasks;
+};
+}
+
+#endif //ALGINE_ANIMATIONBATCH_H
@@ -0,0 +1,82 @@
+#ifndef ALGINE_ASSETPACK_H
+#define ALGINE_ASSETPACK_H
+
+#include <algine/MappedFile.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace algine {
+/**
+ * Read-only view of the pack file, created by `AssetPackWriter` (see `algine_pack` tool).
+ * Pack is memory mapped, so stored entries are accessed without copying,
+ * LZ4 compressed ones are decompressed on reading.
+ * Entries are accessed by name, e.g. "src/resources/models/chess/board.png".
+ * Reading is thread safe
+ */
+class AssetPack {
+public:
+    // must be incremented each time the binary layout changes
+    static constexpr uint Version = 1;
+
+    static constexpr uint Magic = 0x4b504141; // "AAPK"
+
+    // entries data alignment in bytes
+    static constexpr uint Alignment = 64;
+
+    // index follows entries data, each index record is:
+    // uint64 offset, storedSize, size; uint flags, nameLength; char name[nameLength]
+    struct Header {
+        uint magic = Magic, version = Version, entriesCount = 0, reserved = 0;
+        uint64 indexOffset = 0, indexSize = 0;
+    };
+
+    enum EntryFlags {
+        Compressed = 1 // LZ4 block
+    };
+
+    struct Entry {
+        uint64 offset = 0, storedSize = 0, size = 0;
+        uint flags = 0;
+    };
+
+    AssetPack();
+    explicit AssetPack(const std::string &path);
+
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const;
+    bool exists(const std::string &name) const;
+
+    /**
+     * @return entry or nullptr if it doesn't exist
+     */
+    const Entry* getEntry(const std::string &name) const;
+
+    /**
+     * Reads entry `name`: `data` points to the mapped pack if the entry is stored
+     * as is, otherwise entry is decompressed to `buffer` and `data` points to it
+     * @return true on success
+     */
+    bool read(const std::string &name, const ubyte *&data, usize &size, std::vector<ubyte> &buffer) const;
+
+    // reads entry as string, e.g. for text formats
+    bool readString(const std::string &name, std::string &str) const;
+
+    const std::string& getPath() const;
+    std::vector<std::string> getNames() const;
+
+    /**
+     * Converts path to the entry name: '/' separators, without "." and ".." parts
+     */
+    static std::string toEntryName(const std::string &path);
+
+protected:
+    MappedFile m_file;
+    std::unordered_map<std::string, Entry> m_entries;
+    std::string m_path;
+};
+}
+
+#endif //ALGINE_ASSETPACK_H
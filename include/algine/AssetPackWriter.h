@@ -0,0 +1,44 @@
+#ifndef ALGINE_ASSETPACKWRITER_H
+#define ALGINE_ASSETPACKWRITER_H
+
+#include <algine/types.h>
+#include <string>
+#include <vector>
+
+namespace algine {
+/**
+ * Cooks files to the pack, that can be read by `AssetPack`.
+ * Layout: header, entries data (each is aligned to `AssetPack::Alignment`), index
+ */
+class AssetPackWriter {
+public:
+    /**
+     * @param compress compress entry with LZ4, it's stored as is if compression doesn't reduce size
+     */
+    void add(const std::string &name, const std::vector<ubyte> &data, bool compress);
+
+    /**
+     * Adds file `path` as `AssetPack::toEntryName(path)`
+     * @return false if the file can't be read
+     */
+    bool addFile(const std::string &path, bool compress);
+
+    bool save(const std::string &path) const;
+
+    // sizes in bytes of the added data
+    uint64 getSize() const;
+    uint64 getStoredSize() const;
+
+protected:
+    struct PendingEntry {
+        std::string name;
+        std::vector<ubyte> data; // compressed if flags contains AssetPack::Compressed
+        uint64 size;
+        uint flags;
+    };
+
+    std::vector<PendingEntry> m_entries;
+};
+}
+
+#endif //ALGINE_ASSETPACKWRITER_H
@@ -0,0 +1,50 @@
+#ifndef ALGINE_BONEPALETTEBUFFER_H
+#define ALGINE_BONEPALETTEBUFFER_H
+
+#include <algine/Buffer.h>
+#include <glm/mat4x4.hpp>
+#include <vector>
+
+namespace algine {
+/**
+ * Texture buffer with bone palettes of all models, uploaded once per frame
+ * with a single call. Shaders read matrices with `texelFetch`, 4 RGBA32F
+ * texels per matrix. The buffer is orphaned on each upload, so writing
+ * doesn't stall on the previous frames still in flight
+ */
+class BonePaletteBuffer: public Buffer {
+public:
+    /**
+     * @param bonesCount initial capacity in matrices, the buffer grows if needed
+     */
+    explicit BonePaletteBuffer(uint bonesCount = 1024);
+    ~BonePaletteBuffer();
+
+    BonePaletteBuffer(const BonePaletteBuffer &src) = delete;
+    BonePaletteBuffer& operator=(const BonePaletteBuffer &rhs) = delete;
+
+    // starts a new frame, palettes of the previous one are discarded
+    void begin();
+
+    /**
+     * Stages `palette`, it is uploaded by `end`
+     * @return offset of the palette in matrices, `boneOffset` in the shaders
+     */
+    uint add(const std::vector<glm::mat4> &palette);
+
+    // uploads staged palettes
+    void end();
+
+    // binds texture to the texture unit `slot`
+    void use(uint slot) const;
+
+    uint getTexture() const;
+
+protected:
+    std::vector<glm::mat4> m_staging;
+    uint m_texture = 0;
+    uint m_capacity; // in matrices
+};
+}
+
+#endif //ALGINE_BONEPALETTEBUFFER_H
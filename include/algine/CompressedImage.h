@@ -0,0 +1,42 @@
+#ifndef ALGINE_COMPRESSEDIMAGE_H
+#define ALGINE_COMPRESSEDIMAGE_H
+
+#include <algine/types.h>
+#include <string>
+#include <vector>
+
+namespace algine {
+/**
+ * Block compressed image with its mip chain in the CPU memory.
+ * Can be stored on disk, so textures are compressed only once
+ */
+class CompressedImage {
+public:
+    struct Level {
+        uint width, height;
+        std::vector<ubyte> data;
+    };
+
+    /**
+     * Reads image compressed from `sourcePath`.
+     * Cache file stores source file modification time and size,
+     * so outdated cache is ignored
+     * @return true if cache exists and is up to date
+     */
+    bool load(const std::string &path, const std::string &sourcePath);
+
+    /**
+     * @return true on success
+     */
+    bool save(const std::string &path, const std::string &sourcePath) const;
+
+    // total size of all levels in bytes
+    usize getSize() const;
+
+public:
+    uint format = 0; // `Texture::CompressedFormats` value
+    std::vector<Level> levels; // level 0 is the base image
+};
+}
+
+#endif //ALGINE_COMPRESSEDIMAGE_H
@@ -0,0 +1,46 @@
+#ifndef ALGINE_FREELISTALLOCATOR_H
+#define ALGINE_FREELISTALLOCATOR_H
+
+#include <algine/types.h>
+#include <map>
+
+namespace algine {
+/**
+ * First fit range allocator with coalescing of the adjacent free ranges.
+ * Manages only offsets, so it can be used for any memory, e.g. GL buffers
+ */
+class FreeListAllocator {
+public:
+    struct Range {
+        uint offset = 0, size = 0; // size 0 means empty range
+    };
+
+    explicit FreeListAllocator(uint capacity = 0);
+
+    /**
+     * @param alignment offset of the allocated range will be multiple of it
+     * @return true on success, false if there is no free range large enough
+     */
+    bool allocate(uint size, uint alignment, Range &range);
+
+    void free(const Range &range);
+
+    /**
+     * Increases capacity, new space is added to the end
+     */
+    void grow(uint capacity);
+
+    uint getCapacity() const;
+    uint getFreeSize() const;
+
+protected:
+    void addFree(uint offset, uint size);
+
+protected:
+    std::map<uint, uint> m_free; // offset -> size
+    uint m_capacity = 0;
+    uint m_freeSize = 0;
+};
+}
+
+#endif //ALGINE_FREELISTALLOCATOR_H
@@ -0,0 +1,43 @@
+#ifndef ALGINE_GLUPLOADQUEUE_H
+#define ALGINE_GLUPLOADQUEUE_H
+
+#include <algine/types.h>
+#include <queue>
+#include <mutex>
+#include <functional>
+
+namespace algine {
+/**
+ * Queue of the tasks that must be executed on the GL thread, e.g. buffer and
+ * texture uploads prepared by the worker threads.
+ * Tasks can be pushed from any thread; `process` must be called by the GL
+ * thread, usually once per frame
+ */
+class GLUploadQueue {
+public:
+    void push(const std::function<void()> &task);
+
+    /**
+     * Executes queued tasks until `timeBudget` (in seconds) is exceeded.
+     * At least one task is executed if queue is not empty
+     * @return executed tasks count
+     */
+    uint process(double timeBudget = 0.002);
+
+    // executes all queued tasks
+    uint processAll();
+
+    bool isEmpty();
+
+    static GLUploadQueue* getDefault();
+
+protected:
+    bool pop(std::function<void()> &task);
+
+protected:
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+};
+}
+
+#endif //ALGINE_GLUPLOADQUEUE_H
@@ -0,0 +1,66 @@
+#ifndef ALGINE_GEOMETRYHEAP_H
+#define ALGINE_GEOMETRYHEAP_H
+
+#include <algine/model.h>
+#include <algine/FreeListAllocator.h>
+#include <vector>
+#include <memory>
+
+namespace algine {
+/**
+ * Shared GL buffers for many shapes: one vertex buffer per interleaved vertex format
+ * and one index buffer. Shapes suballocate ranges and are drawn with base vertex &
+ * indices offset, so shapes with the same format share the same VAO.
+ * Buffers grow (with data copying) if there is no free range large enough.
+ * Must be used on the GL thread
+ */
+class GeometryHeap {
+public:
+    /**
+     * @param vertexPoolSize, indexPoolSize initial sizes in bytes
+     */
+    explicit GeometryHeap(uint vertexPoolSize = 32u << 20u, uint indexPoolSize = 16u << 20u);
+    ~GeometryHeap();
+
+    GeometryHeap(const GeometryHeap &src) = delete;
+    GeometryHeap& operator=(const GeometryHeap &rhs) = delete;
+
+    /**
+     * Places interleaved vertex data of `shape` to the pool of its vertex format,
+     * allocation offset is added to the base vertex of each mesh
+     */
+    void addVertices(Shape &shape, const std::vector<ubyte> &data);
+
+    /**
+     * Places index data of `shape`, allocation offset is stored in the meshes
+     */
+    void addIndices(Shape &shape, const std::vector<ubyte> &data);
+
+    // frees ranges of `shape`, its shared VAOs stay alive
+    void remove(Shape &shape);
+
+    /**
+     * @return VAO shared by all shapes with the same vertex format and attribute locations
+     */
+    uint getVAO(const Shape &shape, const Shape::AttribLocations &locations);
+
+protected:
+    struct VertexPool {
+        Shape::VertexFormat format;
+        ArrayBuffer *buffer = nullptr;
+        FreeListAllocator allocator; // in vertices
+        std::vector<std::pair<Shape::AttribLocations, uint>> vaos;
+    };
+
+    VertexPool* getPool(const Shape::VertexFormat &format, bool create);
+    void setupVAO(uint vao, const VertexPool &pool, const Shape::AttribLocations &locations);
+
+protected:
+    std::vector<std::unique_ptr<VertexPool>> m_vertexPools;
+    IndexBuffer *m_indices = nullptr;
+    FreeListAllocator m_indicesAllocator; // in bytes
+    uint m_vertexPoolSize;
+};
+}
+
+#endif //ALGINE_GEOMETRYHEAP_H
@@ -0,0 +1,43 @@
+#ifndef ALGINE_IMAGE_H
+#define ALGINE_IMAGE_H
+
+#include <algine/types.h>
+#include <algine/AssetPack.h>
+#include <string>
+
+namespace algine {
+/**
+ * Decoded image in the CPU memory.
+ * Doesn't use OpenGL, so it can be loaded on any thread
+ */
+class Image {
+public:
+    Image();
+    ~Image();
+
+    Image(const Image &src) = delete;
+    Image& operator=(const Image &rhs) = delete;
+    Image(Image &&src) noexcept;
+    Image& operator=(Image &&rhs) noexcept;
+
+    bool fromFile(const std::string &path, bool flipImage = true);
+
+    // decodes encoded (e.g. PNG or JPEG) image from memory
+    bool fromMemory(const ubyte *encoded, usize size, bool flipImage = true);
+
+    // decodes image entry `name` from the `pack`
+    bool fromPack(const AssetPack &pack, const std::string &name, bool flipImage = true);
+    void free();
+
+    /**
+     * @return `Texture::BaseFormats` value suitable for the image channels count
+     */
+    uint getDataFormat() const;
+
+public:
+    ubyte *data = nullptr;
+    uint width = 0, height = 0, channels = 0;
+};
+}
+
+#endif //ALGINE_IMAGE_H
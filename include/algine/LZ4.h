@@ -0,0 +1,28 @@
+#ifndef ALGINE_LZ4_H
+#define ALGINE_LZ4_H
+
+#include <algine/types.h>
+#include <vector>
+
+namespace algine {
+/**
+ * LZ4 block format codec (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+ * Compressor is a simple greedy one: speed is less important than decompression speed,
+ * since assets are compressed once while cooking
+ */
+class LZ4 {
+public:
+    /**
+     * Compresses `size` bytes of `src` and appends result to `dst`
+     */
+    static void compress(const ubyte *src, usize size, std::vector<ubyte> &dst);
+
+    /**
+     * @param dstSize exact decompressed size
+     * @return true on success, false if `src` is malformed
+     */
+    static bool decompress(const ubyte *src, usize srcSize, ubyte *dst, usize dstSize);
+};
+}
+
+#endif //ALGINE_LZ4_H
@@ -0,0 +1,76 @@
+#ifndef ALGINE_LOADSTATS_H
+#define ALGINE_LOADSTATS_H
+
+#include <algine/types.h>
+#include <chrono>
+
+namespace algine {
+/**
+ * Wall time & allocations of the `ShapeLoader` stages, see `ShapeLoader::setLoadStats`.
+ * If a stage is executed several times (e.g. uploads), values are accumulated.
+ * Allocations are counted only if `allocationsCounter` is set, since it requires
+ * global operator new replacement (see algine_bench). Stages use the thread pool,
+ * so allocations of the other threads made at the same time are counted too
+ */
+class LoadStats {
+public:
+    enum Stages {
+        AMTLParse,
+        CacheLoad,
+        AssimpImport,
+        NodesAnimationsCopy, // nodes tree & animations
+        ProcessNodes, // meshes import
+        MeshPostProcess, // algine params: optimization, lods, meshlets
+        CacheSave,
+        TexturesDecode, // including mipmaps generation & compression
+        BuffersPrepare,
+        TexturesUpload, // GL
+        BuffersUpload, // GL
+        StagesCount
+    };
+
+    struct Stage {
+        double time = 0; // in milliseconds
+        uint64 allocations = 0, allocatedBytes = 0;
+        uint calls = 0;
+    };
+
+    struct AllocationsInfo {
+        uint64 allocations = 0, allocatedBytes = 0;
+    };
+
+    // measures stage in the scope, `stats` can be null
+    class Scope {
+    public:
+        Scope(LoadStats *stats, uint stage);
+        ~Scope();
+
+        Scope(const Scope &src) = delete;
+        Scope& operator=(const Scope &rhs) = delete;
+
+    protected:
+        LoadStats *m_stats;
+        uint m_stage;
+    };
+
+    void begin(uint stage);
+    void end(uint stage);
+    void reset();
+
+    const Stage& get(uint stage) const;
+    double getTotalTime() const;
+
+    static const char* getStageName(uint stage);
+
+public:
+    // returns total allocations made by the process
+    static AllocationsInfo (*allocationsCounter)();
+
+protected:
+    Stage m_stages[StagesCount];
+    std::chrono::steady_clock::time_point m_beginTime[StagesCount];
+    AllocationsInfo m_beginAllocations[StagesCount];
+};
+}
+
+#endif //ALGINE_LOADSTATS_H
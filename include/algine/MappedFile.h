@@ -0,0 +1,39 @@
+#ifndef ALGINE_MAPPEDFILE_H
+#define ALGINE_MAPPEDFILE_H
+
+#include <algine/types.h>
+#include <string>
+
+namespace algine {
+/**
+ * Read-only memory mapped view of the whole file
+ */
+class MappedFile {
+public:
+    MappedFile();
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &src) = delete;
+    MappedFile& operator=(const MappedFile &rhs) = delete;
+
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const;
+    const ubyte* getData() const;
+    usize getSize() const;
+
+protected:
+    const ubyte *m_data = nullptr;
+    usize m_size = 0;
+
+#ifdef _WIN32
+    void *m_file = nullptr, *m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+}
+
+#endif //ALGINE_MAPPEDFILE_H
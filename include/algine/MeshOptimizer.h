@@ -0,0 +1,80 @@
+#ifndef ALGINE_MESHOPTIMIZER_H
+#define ALGINE_MESHOPTIMIZER_H
+
+#include <algine/types.h>
+#include <algine/Meshlet.h>
+#include <vector>
+
+namespace algine {
+/**
+ * Index / vertex reordering for faster rendering.
+ * All functions work with triangle lists, indices must be in [0, verticesCount)
+ */
+class MeshOptimizer {
+public:
+    /**
+     * Reorders triangles for post-transform vertex cache locality (Tipsify, Sander et al. 2007)
+     * @param cacheSize size of the simulated vertex cache
+     */
+    static void optimizeVertexCache(uint *indices, usize indicesCount, usize verticesCount, uint cacheSize = 16);
+
+    /**
+     * Splits cache optimized triangle list to clusters and sorts them
+     * to reduce overdraw (outward facing clusters first)
+     * @param positions 3 floats per vertex
+     * @param threshold max allowed ACMR growth, 1.05 means +5%
+     */
+    static void optimizeOverdraw(uint *indices, usize indicesCount, const float *positions, usize verticesCount,
+            uint cacheSize = 16, float threshold = 1.05f);
+
+    /**
+     * Renumbers vertices in order of their first use, so vertex fetch becomes linear.
+     * Indices are rewritten in place; vertex data must be permuted with returned remap table
+     * @return remap table: new index = remap[old index]
+     */
+    static std::vector<uint> optimizeVertexFetch(uint *indices, usize indicesCount, usize verticesCount);
+
+    /**
+     * Simplifies mesh by quadric error metric edge collapses (Garland & Heckbert 1997).
+     * Collapses move vertex to its neighbour, so no new vertices are created and
+     * the result can be drawn with the same vertex data.
+     * Vertices on borders and attribute seams are locked
+     * @param positions 3 floats per vertex
+     * @param targetIndicesCount simplification stops when result has not more indices
+     * @param maxError max allowed distance error
+     * @param resultError if not null, receives the achieved distance error
+     * @return simplified indices
+     */
+    static std::vector<uint> simplify(const uint *indices, usize indicesCount, const float *positions, usize verticesCount,
+            usize targetIndicesCount, float maxError, float *resultError = nullptr);
+
+    /**
+     * Splits triangle list to meshlets of contiguous index ranges, triangles order is kept.
+     * Gives compact meshlets if indices are optimized for vertex cache
+     * @param positions 3 floats per vertex
+     * @return meshlets, `Meshlet::start` is relative to `indices`
+     */
+    static std::vector<Meshlet> buildMeshlets(const uint *indices, usize indicesCount, const float *positions,
+            uint maxVertices = 64, uint maxTriangles = 124);
+
+    /**
+     * @return average cache miss ratio (vertex shader invocations per triangle)
+     */
+    static float getACMR(const uint *indices, usize indicesCount, usize verticesCount, uint cacheSize = 16);
+
+    /**
+     * Permutes vertex data according to the `remap` table
+     * @param components components count per vertex
+     */
+    template<typename T>
+    static void remapVertices(T *data, uint components, const std::vector<uint> &remap) {
+        std::vector<T> src(data, data + remap.size() * components);
+
+        for (usize i = 0; i < remap.size(); i++)
+            for (uint j = 0; j < components; j++)
+                data[remap[i] * components + j] = src[i * components + j];
+    }
+};
+}
+
+#endif //ALGINE_MESHOPTIMIZER_H
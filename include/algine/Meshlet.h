@@ -0,0 +1,46 @@
+#ifndef ALGINE_MESHLET_H
+#define ALGINE_MESHLET_H
+
+#include <algine/types.h>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+namespace algine {
+/**
+ * Small cluster of the mesh triangles with bounds for culling.
+ * All bounds are in model space
+ */
+struct Meshlet {
+    uint start = 0, count = 0; // range in Geometry::indices
+
+    // bounding sphere
+    glm::vec3 center;
+    float radius = 0;
+
+    // normal cone: average normal and sine of the normals spread,
+    // cutoff 1 means that meshlet can't be back-face culled
+    glm::vec3 coneAxis;
+    float coneCutoff = 1;
+
+    /**
+     * @param planes frustum planes in model space, see `getFrustumPlanes`
+     * @return true if bounding sphere is inside or intersects frustum
+     */
+    bool isInFrustum(const glm::vec4 *planes) const;
+
+    /**
+     * @param cameraPos camera position in model space
+     * @return true if all triangles are back-facing to the camera
+     */
+    bool isBackFacing(const glm::vec3 &cameraPos) const;
+
+    /**
+     * Extracts 6 normalized frustum planes from matrix.
+     * If `matrix` is projection * view * model, planes will be in model space
+     */
+    static void getFrustumPlanes(const glm::mat4 &matrix, glm::vec4 *planes);
+};
+}
+
+#endif //ALGINE_MESHLET_H
@@ -0,0 +1,45 @@
+#ifndef ALGINE_MIPMAPGENERATOR_H
+#define ALGINE_MIPMAPGENERATOR_H
+
+#include <algine/types.h>
+#include <vector>
+
+namespace algine {
+/**
+ * CPU mip chain generation for 8 bit images. Doesn't use OpenGL, so it can be used on any thread.
+ * Each level is filtered from the previous one, which is kept in float to avoid requantization
+ */
+class MipmapGenerator {
+public:
+    enum Filters {
+        Box, // 2x2 average
+        Kaiser // 6 taps Kaiser windowed sinc, sharper than box
+    };
+
+    enum Flags {
+        GammaCorrect = 1u << 0u, // color channels are sRGB, filtering is done in linear space
+        NormalMap = 1u << 1u // RGB is unit vector in [0; 1], filtered vectors are renormalized
+    };
+
+    struct Level {
+        uint width, height;
+        std::vector<ubyte> data;
+    };
+
+    /**
+     * Generates mip levels from 1 to 1x1
+     * @param data base level, `channels` bytes per pixel
+     * @param flags combination of `Flags`
+     * @return levels, starting from level 1
+     */
+    static std::vector<Level> generate(const ubyte *data, uint width, uint height, uint channels,
+            uint filter = Kaiser, uint flags = 0);
+
+    /**
+     * @return levels count of the full mip chain, including base level
+     */
+    static uint getLevelsCount(uint width, uint height);
+};
+}
+
+#endif //ALGINE_MIPMAPGENERATOR_H
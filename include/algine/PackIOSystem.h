@@ -0,0 +1,46 @@
+#ifndef ALGINE_PACKIOSYSTEM_H
+#define ALGINE_PACKIOSYSTEM_H
+
+#include <algine/AssetPack.h>
+#include <assimp/IOSystem.hpp>
+#include <assimp/IOStream.hpp>
+
+namespace algine {
+/**
+ * Assimp file system over the `AssetPack`, so Assimp can read models
+ * and their dependencies (e.g. OBJ materials) from the pack.
+ * Usage: importer.SetIOHandler(new PackIOSystem(pack)), importer takes ownership
+ */
+class PackIOSystem: public Assimp::IOSystem {
+public:
+    explicit PackIOSystem(const AssetPack *pack);
+
+    bool Exists(const char *file) const override;
+    char getOsSeparator() const override;
+    Assimp::IOStream* Open(const char *file, const char *mode = "rb") override;
+    void Close(Assimp::IOStream *file) override;
+
+protected:
+    const AssetPack *m_pack;
+};
+
+// read-only stream over the pack entry
+class PackIOStream: public Assimp::IOStream {
+public:
+    size_t Read(void *buffer, size_t size, size_t count) override;
+    size_t Write(const void *buffer, size_t size, size_t count) override;
+    aiReturn Seek(size_t offset, aiOrigin origin) override;
+    size_t Tell() const override;
+    size_t FileSize() const override;
+    void Flush() override;
+
+protected:
+    friend class PackIOSystem;
+
+    const ubyte *m_data = nullptr;
+    usize m_size = 0, m_pos = 0;
+    std::vector<ubyte> m_buffer; // decompressed data, if the entry is compressed
+};
+}
+
+#endif //ALGINE_PACKIOSYSTEM_H
@@ -0,0 +1,36 @@
+#ifndef ALGINE_SHAPECACHE_H
+#define ALGINE_SHAPECACHE_H
+
+#include <algine/types.h>
+#include <string>
+
+namespace algine {
+class ShapeLoader;
+
+/**
+ * On-disk cache of the cooked `ShapeLoader` output: geometry, meshes, materials,
+ * bones, node tree and animations. Lets `ShapeLoader` skip Assimp import and
+ * scene processing on warm loads.
+ * Cache is keyed by model path, model & AMTL modification time and size,
+ * loader params and bones per vertex. If the key doesn't match, the cache is ignored
+ */
+class ShapeCache {
+public:
+    // must be incremented each time the binary layout changes
+    static constexpr uint Version = 7;
+
+    /**
+     * Reads cache from `path` to `loader`
+     * @return true if cache exists, is valid and matches the loader state
+     */
+    static bool load(const std::string &path, ShapeLoader &loader);
+
+    /**
+     * Writes current `loader` output to `path`
+     * @return true on success
+     */
+    static bool save(const std::string &path, const ShapeLoader &loader);
+};
+}
+
+#endif //ALGINE_SHAPECACHE_H
@@ -0,0 +1,51 @@
+#ifndef ALGINE_SKELETON_H
+#define ALGINE_SKELETON_H
+
+#include <algine/types.h>
+#include <algine/node.h>
+#include <algine/bone.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <glm/mat4x4.hpp>
+
+namespace algine {
+class Animation;
+
+/**
+ * Node hierarchy flattened to arrays, so it can be evaluated with the flat loop
+ * without recursion and name lookups. Nodes are sorted in depth-first order,
+ * so each parent precedes its children
+ */
+class Skeleton {
+public:
+    /**
+     * `rootNode` tree must not be changed structurally or moved while
+     * the skeleton is used, since `nodes` point to it
+     */
+    void build(Node &rootNode, const std::vector<Bone> &bones, const std::vector<Animation> &animations);
+
+    /**
+     * @return node index or -1 if the node doesn't exist
+     */
+    int getNodeIndex(const std::string &name) const;
+
+    usize getNodesCount() const;
+
+public:
+    std::vector<Node*> nodes; // source nodes
+    std::vector<std::string> names;
+    std::vector<int> parents; // -1 for the root
+    std::vector<glm::mat4> defaultTransforms, transformations; // see Node
+    std::vector<int> bones; // node -> index in Shape::bones or -1
+    std::vector<std::vector<int>> channels; // animation -> node -> index in Animation::channels or -1
+
+protected:
+    void addNode(Node &node, int parent);
+
+protected:
+    std::unordered_map<std::string, uint> m_nodeIndices;
+};
+}
+
+#endif //ALGINE_SKELETON_H
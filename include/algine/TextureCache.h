@@ -0,0 +1,100 @@
+#ifndef ALGINE_TEXTURECACHE_H
+#define ALGINE_TEXTURECACHE_H
+
+#include <algine/texture.h>
+#include <string>
+#include <map>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+namespace algine {
+/**
+ * Thread-safe cache of the loaded textures, keyed by (path, params).
+ * Each entry has its GPU size; if the total size exceeds the budget, least
+ * recently used entries which are referenced only by the cache are evicted.
+ * Eviction deletes GL textures, so functions that evict must be called on the GL thread
+ */
+class TextureCache {
+public:
+    struct Key {
+        std::string path;
+        std::map<uint, uint> params;
+
+        bool operator==(const Key &other) const;
+    };
+
+    struct KeyHash {
+        usize operator()(const Key &key) const;
+    };
+
+    /**
+     * @param budget in bytes, 0 means unlimited
+     */
+    explicit TextureCache(usize budget = 0);
+
+    TextureCache(const TextureCache &src) = delete;
+    TextureCache& operator=(const TextureCache &rhs) = delete;
+
+    /**
+     * Marks entry as recently used
+     * @return cached texture or nullptr
+     */
+    std::shared_ptr<Texture2D> get(const Key &key);
+
+    /**
+     * Adds `texture` with GPU size `size` and evicts unused entries if budget is exceeded.
+     * If `key` is already cached (e.g. added by the other thread), cached texture is kept
+     * @return cached texture
+     */
+    std::shared_ptr<Texture2D> add(const Key &key, const std::shared_ptr<Texture2D> &texture, usize size);
+
+    /**
+     * Evicts least recently used entries, which are referenced only
+     * by the cache, until the total size fits the budget
+     * @return evicted entries count
+     */
+    uint evict();
+
+    // removes all entries which are referenced only by the cache
+    void clear();
+
+    void setBudget(usize budget);
+    usize getBudget();
+    usize getSize(); // total size of the cached textures in bytes
+    usize getCount();
+
+    /**
+     * @param format internal format of the texture
+     * @param mipmaps if true, the full mip chain is counted
+     * @return GPU size of the texture in bytes
+     */
+    static usize getTextureSize(uint width, uint height, uint format, bool mipmaps = true);
+
+    /**
+     * @return bytes per pixel of the uncompressed internal `format` as it is
+     * usually stored by drivers: 3 component formats are padded to 4
+     */
+    static uint getBytesPerPixel(uint format);
+
+    static TextureCache* getDefault();
+
+protected:
+    uint evictLocked(usize budget);
+
+protected:
+    struct Entry {
+        std::shared_ptr<Texture2D> texture;
+        usize size;
+        std::list<Key>::iterator lruPosition;
+    };
+
+    std::unordered_map<Key, Entry, KeyHash> m_entries;
+    std::list<Key> m_lru; // front is the most recently used
+    std::mutex m_mutex;
+    usize m_budget, m_size = 0;
+};
+}
+
+#endif //ALGINE_TEXTURECACHE_H
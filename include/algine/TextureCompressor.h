@@ -0,0 +1,55 @@
+#ifndef ALGINE_TEXTURECOMPRESSOR_H
+#define ALGINE_TEXTURECOMPRESSOR_H
+
+#include <algine/Image.h>
+#include <algine/CompressedImage.h>
+#include <algine/MipmapGenerator.h>
+
+namespace algine {
+/**
+ * CPU block compression encoders. Doesn't use OpenGL, so it can be used on any thread.
+ * BC1 - RGB, 8 bytes per 4x4 block; BC3 - RGBA, 16 bytes per block;
+ * BC5 - RG (e.g. normal maps with reconstructed z), 16 bytes per block
+ */
+class TextureCompressor {
+public:
+    /**
+     * Compresses `image` and its full mip chain to `format`
+     * @param format `Texture::CompressedFormats` value
+     * @param mipmapFilter, mipmapFlags see `MipmapGenerator`
+     * @return true on success
+     */
+    static bool compress(const Image &image, uint format, CompressedImage &result,
+            uint mipmapFilter = MipmapGenerator::Kaiser, uint mipmapFlags = 0);
+
+    /**
+     * @param rgba 16 pixels, 4 bytes per pixel
+     * @param block 8 bytes
+     */
+    static void encodeBC1Block(const ubyte *rgba, ubyte *block);
+
+    /**
+     * @param values 16 values with `stride` bytes between them
+     * @param block 8 bytes
+     */
+    static void encodeBC4Block(const ubyte *values, uint stride, ubyte *block);
+
+    // 16 bytes block: BC4 alpha + BC1 color
+    static void encodeBC3Block(const ubyte *rgba, ubyte *block);
+
+    // 16 bytes block: BC4 red + BC4 green
+    static void encodeBC5Block(const ubyte *rgba, ubyte *block);
+
+    /**
+     * @return block size in bytes or 0 if format is not supported
+     */
+    static uint getBlockSize(uint format);
+
+    /**
+     * @return true if image has at least one not opaque pixel
+     */
+    static bool hasAlpha(const Image &image);
+};
+}
+
+#endif //ALGINE_TEXTURECOMPRESSOR_H
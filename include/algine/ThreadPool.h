@@ -0,0 +1,86 @@
+#ifndef ALGINE_THREADPOOL_H
+#define ALGINE_THREADPOOL_H
+
+#include <algine/types.h>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <chrono>
+
+namespace algine {
+/**
+ * Fixed size pool of worker threads.
+ * Tasks must not call OpenGL functions: workers have no GL context
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(uint threadsCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &src) = delete;
+    ThreadPool& operator=(const ThreadPool &rhs) = delete;
+
+    template<typename F>
+    auto submit(F &&task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+
+        // std::function requires copyable callable, std::packaged_task is move-only
+        auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packagedTask->get_future();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_tasks.emplace([packagedTask]() { (*packagedTask)(); });
+        }
+
+        m_condition.notify_one();
+
+        return result;
+    }
+
+    /**
+     * Waits for `future`, executing queued tasks meanwhile.
+     * Allows tasks to wait for their subtasks without deadlocks
+     */
+    template<typename T>
+    void wait(std::future<T> &future) {
+        while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            // queue is empty: the task is executing by another thread
+            if (!runPendingTask()) {
+                future.wait();
+                return;
+            }
+        }
+    }
+
+    /**
+     * Executes one queued task on the calling thread
+     * @return false if there are no queued tasks
+     */
+    bool runPendingTask();
+
+    uint getThreadsCount() const;
+
+    /**
+     * @return pool shared by the engine loaders
+     */
+    static ThreadPool* getDefault();
+
+protected:
+    void workerLoop();
+
+protected:
+    std::vector<std::thread> m_threads;
+    std::queue<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop = false;
+};
+}
+
+#endif //ALGINE_THREADPOOL_H
@@ -0,0 +1,32 @@
+#ifndef ALGINE_VERTEXQUANTIZER_H
+#define ALGINE_VERTEXQUANTIZER_H
+
+#include <algine/types.h>
+
+namespace algine {
+/**
+ * Conversions of the vertex attributes to the compact GPU formats
+ */
+class VertexQuantizer {
+public:
+    // IEEE 754 half precision float, round to nearest
+    static uint16 toHalf(float value);
+
+    // value must be in [0, 1]
+    static uint16 toUnorm16(float value);
+
+    // value must be in [-1, 1]
+    static int16 toSnorm16(float value);
+
+    /**
+     * Octahedral encoding of the unit vector to 2 snorm16 components.
+     * Decoding (GLSL):
+     * v = vec3(e, 1 - abs(e.x) - abs(e.y));
+     * if (v.z < 0) v.xy = (1 - abs(v.yx)) * signNotZero(v.xy);
+     * v = normalize(v);
+     */
+    static void toOctahedral(const float *vector, int16 *result);
+};
+}
+
+#endif //ALGINE_VERTEXQUANTIZER_H
@@ -7,6 +7,8 @@
 namespace algine {
 void pointer(int location, int count, uint buffer, uint stride = 0, const void *offset = nullptr);
 void pointerui(int location, int count, uint buffer, uint stride = 0, const void *offset = nullptr);
+void pointer(int location, int count, uint buffer, uint type, bool normalized, uint stride, const void *offset);
+void pointerui(int location, int count, uint buffer, uint type, uint stride, const void *offset);
 
 class CubeRenderer {
 public:
@@ -7,6 +7,7 @@
 
 #include <algine/node.h>
 #include <algine/bone.h>
+#include <algine/Skeleton.h>
 
 namespace algine {
 class VecAnimKey {
@@ -14,6 +15,7 @@ public:
     double time;
     glm::vec3 value;
 
+    VecAnimKey();
     VecAnimKey(const aiVectorKey *key);
 
     float getTime();
@@ -24,6 +26,7 @@ public:
     double time;
     glm::quat value;
 
+    QuatAnimKey();
     QuatAnimKey(const aiQuatKey *key);
 
     float getTime();
@@ -35,6 +38,7 @@ public:
     std::vector<VecAnimKey> scalingKeys, positionKeys;
     std::vector<QuatAnimKey> rotationKeys;
 
+    AnimNode();
     AnimNode(const aiNodeAnim *nodeAnim);
 };
 
@@ -44,6 +48,7 @@ public:
     std::string name;
     std::vector<AnimNode> channels;
 
+    Animation();
     Animation(const aiAnimation *anim);
 };
 
@@ -53,20 +58,44 @@ public:
     std::vector<Bone> *bones;
     glm::mat4 *globalInverseTransform;
     Node *rootNode;
+    Skeleton *skeleton = nullptr; // if not null, it's used instead of rootNode
 
     AnimShape();
-    AnimShape(std::vector<Animation> *animations, std::vector<Bone> *bones, glm::mat4 *globalInverseTransform, Node *rootNode);
+    AnimShape(std::vector<Animation> *animations, std::vector<Bone> *bones, glm::mat4 *globalInverseTransform, Node *rootNode,
+            Skeleton *skeleton = nullptr);
 };
 
 class Animator {
+public:
+    enum SkinningMode {
+        LinearBlendSkinning, // palette of matrices
+        /**
+         * Palette of dual quaternions (real, dual), packed two bones per matrix:
+         * bone `i` is in columns `i % 2 * 2` and `i % 2 * 2 + 1` of `palette[i / 2]`.
+         * Bone transformations must be rigid, scaling is dropped.
+         * Shaders must be built with ALGINE_DQ_SKINNING
+         */
+        DualQuaternionSkinning
+    };
+
 public:
     AnimShape shape;
     usize animationIndex;
+    SkinningMode skinningMode = LinearBlendSkinning; // used only if animate writes to palette
 
     Animator();
     Animator(const AnimShape &shape, const usize animationIndex = 0);
 
+    // writes bone transformations to `Bone::finalTransformation` of the shape
     void animate(const float timeInSeconds);
+
+    /**
+     * Writes bone transformations to `palette` (resized to the bones count,
+     * or half of it for dual quaternions) instead of the shape bones,
+     * so many instances can share one Shape
+     */
+    void animate(float timeInSeconds, std::vector<glm::mat4> &palette);
+
     static usize findPosition(const float animationTime, const AnimNode *animNode);
     static void calcInterpolatedPosition(glm::vec3 &out, const float animationTime, const AnimNode *animNode);
     static usize findRotation(const float animationTime, const AnimNode *animNode);
@@ -75,6 +104,29 @@ public:
     static void calcInterpolatedScaling(glm::vec3 &out, const float animationTime, const AnimNode *animNode);
     static const AnimNode* findNodeAnim(const Animation *animation, const std::string &nodeName);
     void readNodeHeirarchy(const float animationTime, const Node &node, const glm::mat4 &parentTransform);
+
+protected:
+    // indices of the last used keys, so the next lookup starts from them
+    struct ChannelCursor {
+        usize position = 0, rotation = 0, scaling = 0;
+    };
+
+    // `cursor` is updated, lookup is O(1) while time goes forward, O(log(keys)) on seeks & loops
+    static void calcInterpolatedPosition(glm::vec3 &out, float animationTime, const AnimNode *animNode, usize &cursor);
+    static void calcInterpolatedRotation(glm::quat &out, float animationTime, const AnimNode *animNode, usize &cursor);
+    static void calcInterpolatedScaling(glm::vec3 &out, float animationTime, const AnimNode *animNode, usize &cursor);
+
+    // evaluates the flattened hierarchy, see Skeleton
+    void animateSkeleton(float animationTime);
+
+    // writes to m_palette if it is set, otherwise to the shape bone
+    void setBoneTransformation(usize index, const glm::mat4 &transformation);
+
+protected:
+    std::vector<ChannelCursor> m_cursors; // for each channel of the current animation
+    usize m_cursorsAnimation = 0;
+    std::vector<glm::mat4> m_globalTransforms; // for each skeleton node
+    std::vector<glm::mat4> *m_palette = nullptr; // output of the current animate call
 };
 
 } /* namespace algine */
@@ -6,26 +6,6 @@
 #include <glm/mat4x4.hpp>
 
 namespace algine {
-struct BoneInfo {
-    uint *ids = nullptr, size;
-    float *weights = nullptr;
-
-    BoneInfo(const uint &size);
-
-    void add(const uint &id, const float &weight);
-
-    // copy constructor
-    BoneInfo(const BoneInfo &src);
-
-    // move constructor
-    BoneInfo(BoneInfo &&src);
-
-    ~BoneInfo();
-
-private:
-    void fill();
-};
-
 struct Bone {
     std::string name;
     glm::mat4 offsetMatrix, finalTransformation;
@@ -68,6 +68,7 @@ namespace algine {
             constant(BoneSystem, "ALGINE_BONE_SYSTEM_ENABLED")
             constant(MaxBoneAttribsPerVertex, "MAX_BONE_ATTRIBS_PER_VERTEX")
             constant(MaxBones, "MAX_BONES")
+            constant(DualQuaternionSkinning, "ALGINE_DQ_SKINNING") // see Animator::DualQuaternionSkinning
             constant(OutputType, "vecout")
             constant(TexComponent, "texComponent")
             constant(SSR, "ALGINE_SSR_MODE_ENABLED") // TODO: remove from fragment_shader.glsl
@@ -121,7 +122,8 @@ namespace algine {
             constant(ViewMatrix, "viewMatrix")
             constant(MVPMatrix, "MVPMatrix")
             constant(MVMatrix, "MVMatrix")
-            constant(Bones, "bones[0]") // zero element, so ShaderProgram.getLocation(Bones) + i, not bones[i]
+            constant(Bones, "bones") // samplerBuffer, see BonePaletteBuffer
+            constant(BoneOffset, "boneOffset")
             constant(BoneAttribsPerVertex, "boneAttribsPerVertex") // bonesPerVertex / 4 + (bonesPerVertex % 4 == 0 ? 0 : 1)
             constant(InPos, "inPos")
             constant(InNormal, "inNormal")
@@ -130,6 +132,9 @@ namespace algine {
             constant(InBitangent, "inBitangent")
             constant(InBoneIds, "inBoneIds[0]") // integer
             constant(InBoneWeights, "inBoneWeights[0]")
+            constant(PositionOffset, "positionOffset")
+            constant(PositionScale, "positionScale")
+            constant(OctahedralNormals, "octahedralNormals")
 
             constant(CameraPos, "cameraPos")
             constant(PointLightsCount, "pointLightsCount")
@@ -143,6 +148,7 @@ namespace algine {
                 constant(DiffuseTex, "material.diffuse")
                 constant(SpecularTex, "material.specular")
                 constant(NormalTex, "material.normal")
+                constant(IsNormalTexRG, "material.normalRG")
                 constant(ReflectionStrengthTex, "material.reflectionStrength")
                 constant(JitterTex, "material.jitter")
                 constant(AmbientColor, "material.cambient")
@@ -179,9 +185,12 @@ namespace algine {
             constant(InPos, "a_Position")
             constant(InBoneIds, "a_BoneIds[0]") // integer
             constant(InBoneWeights, "a_BoneWeights[0]")
-            constant(Bones, "bones[0]")
+            constant(Bones, "bones")
+            constant(BoneOffset, "boneOffset")
             constant(BoneAttribsPerVertex, "boneAttribsPerVertex") // bonesPerVertex / 4 + (bonesPerVertex % 4 == 0 ? 0 : 1)
             constant(TransformationMatrix, "transformationMatrix")
+            constant(PositionOffset, "positionOffset")
+            constant(PositionScale, "positionScale")
 
             namespace PointLight {
                 constant(ShadowMatrices, "shadowMatrices[0]") // from geometry shader
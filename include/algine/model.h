@@ -6,26 +6,86 @@
 #include <algine/AMTLLoader.h>
 #include <algine/bone.h>
 #include <algine/animation.h>
+#include <algine/Skeleton.h>
 #include <algine/object3d.h>
 #include <algine/ArrayBuffer.h>
 #include <algine/IndexBuffer.h>
+#include <algine/Meshlet.h>
+#include <algine/GLUploadQueue.h>
+#include <algine/TextureCache.h>
+#include <algine/MipmapGenerator.h>
+#include <algine/FreeListAllocator.h>
+#include <algine/LoadStats.h>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <future>
 #include <assimp/scene.h> // Output data structure
 
 namespace algine {
+class GeometryHeap;
+
 struct Geometry {
     std::vector<float> vertices, normals, texCoords, tangents, bitangents, boneWeights;
     std::vector<uint> indices, boneIds;
+
+    // size of the stored data in bytes
+    usize getSize() const;
 };
 
 struct Mesh {
+    // simplified level of detail, uses the same vertices as the mesh
+    struct Lod {
+        uint start = 0, count = 0;
+        float error = 0; // simplification error in model space
+    };
+
     uint start = 0, count = 0;
+    uint indexType = GL_UNSIGNED_INT; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    int baseVertex = 0; // added to each index while drawing
+    uint indicesByteOffset = 0; // offset of the shape indices inside shared index buffer, see `GeometryHeap`
     Material material;
+    std::vector<Lod> lods; // levels starting from 1, level 0 is the mesh itself
+
+    // positions dequantization: position * positionScale + positionOffset
+    glm::vec3 positionOffset, positionScale = glm::vec3(1.0f);
+    uint meshletsStart = 0, meshletsCount = 0; // range in Shape::meshlets, level 0 only
+
+    // returns the nearest existing level
+    inline Lod getLod(const uint level) const {
+        if (level == 0 || lods.empty())
+            return {start, count, 0};
+
+        return lods[(level < lods.size() ? level : lods.size()) - 1];
+    }
+
+    inline uint getIndexSize() const {
+        return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16) : sizeof(uint);
+    }
+
+    // byte offset of the first index of `level` inside index buffer
+    inline const void* getIndicesOffset(const uint level = 0) const {
+        return reinterpret_cast<const void*>(static_cast<usize>(getLod(level).start) * getIndexSize() + indicesByteOffset);
+    }
 };
 
 class Shape {
 public:
+    struct Buffers;
+    struct VertexFormat;
+
+    // vertex attribute locations, -1 if attribute is not used
+    struct AttribLocations {
+        int position = -1, texCoord = -1, normal = -1, tangent = -1, bitangent = -1, boneWeights = -1, boneIds = -1;
+
+        inline bool operator==(const AttribLocations &rhs) const {
+            return position == rhs.position && texCoord == rhs.texCoord && normal == rhs.normal &&
+                   tangent == rhs.tangent && bitangent == rhs.bitangent &&
+                   boneWeights == rhs.boneWeights && boneIds == rhs.boneIds;
+        }
+    };
+
+    // deletes own buffers & VAOs or frees ranges in `heap`
     void delBuffers();
 
     // TODO: move it to ShapeLoader
@@ -38,23 +98,60 @@ public:
             int inBoneWeights = -1, int inBoneIds = -1
         );
 
+    /**
+     * Enables & specifies vertex attributes of the currently bound VAO
+     */
+    static void setAttribPointers(const VertexFormat &format, const Buffers &buffers, const AttribLocations &locations);
+
     void setNodeTransform(const std::string &nodeName, const glm::mat4 &transformation);
     void recycle();
 
 public:
     std::vector<Mesh> meshes;
+    std::vector<Meshlet> meshlets;
     std::vector<Bone> bones;
     std::vector<Animation> animations;
     glm::mat4 globalInverseTransform;
     std::vector<uint> vaos;
     Node rootNode;
+    Skeleton skeleton; // flattened rootNode, built by ShapeLoader
     Geometry geometry;
     uint bonesPerVertex = 0;
 
+    // max simplification error of each level among all meshes, empty if there are no lods
+    std::vector<float> lodErrors;
+
+    // bounding sphere in model space
+    glm::vec3 boundingCenter;
+    float boundingRadius = 0;
+
     struct Buffers {
-        ArrayBuffer *vertices, *normals, *texCoords, *tangents, *bitangents, *boneWeights, *boneIds;
-        IndexBuffer *indices;
+        ArrayBuffer
+            *vertices = nullptr, *normals = nullptr, *texCoords = nullptr,
+            *tangents = nullptr, *bitangents = nullptr,
+            *boneWeights = nullptr, *boneIds = nullptr;
+        ArrayBuffer *interleaved = nullptr; // if not null, contains all vertex attributes
+        IndexBuffer *indices = nullptr;
     } buffers;
+
+    struct VertexAttribFormat {
+        uint count = 0; // components count, 0 if attribute is absent
+        uint type = GL_FLOAT;
+        bool normalized = false;
+        uint size = 0; // size per vertex in bytes
+        uint offset = 0; // offset inside the interleaved vertex
+    };
+
+    // describes how vertex attributes are stored in `buffers`
+    struct VertexFormat {
+        uint stride = 0; // interleaved vertex size, 0 for separate buffers
+        bool octahedral = false; // normals, tangents and bitangents are octahedral encoded
+        VertexAttribFormat vertices, normals, texCoords, tangents, bitangents, boneWeights, boneIds;
+    } vertexFormat;
+
+    // if not null, vertices & indices are suballocated from the shared buffers
+    GeometryHeap *heap = nullptr;
+    FreeListAllocator::Range vertexRange, indexRange; // in vertices and bytes
 };
 
 // `Model` is a container for `Shape`, that have own `Animator` and transformations
@@ -64,19 +161,76 @@ public:
 
     void updateMatrix();
 
+    /**
+     * Selects the coarsest `lod` which simplification error, projected
+     * to the screen, is not greater than `maxPixelError`. So the level
+     * depends on the screen-space size of the model
+     * @param viewportHeight in pixels
+     */
+    void updateLod(const glm::mat4 &view, const glm::mat4 &projection, float viewportHeight, float maxPixelError = 1.0f);
+
+    /**
+     * Animates own `palette` with `animator`, so instances of the same
+     * Shape can be posed independently. Each instance needs own Animator
+     */
+    void animate(float timeInSeconds);
+
+    /**
+     * Same as `animate`, but writes to `backPalette`, so the next pose can be
+     * evaluated while the current one is rendered. See `AnimationBatch`
+     */
+    void animateBack(float timeInSeconds);
+
+    void swapPalettes();
+
 public:
     Shape *shape = nullptr;
     Animator *animator = nullptr;
+    std::vector<glm::mat4> palette; // bone transformations of this instance
+    std::vector<glm::mat4> backPalette;
+    uint paletteOffset = 0; // offset of `palette` in the BonePaletteBuffer
     glm::mat4 m_transform;
+    uint lod = 0;
 };
 
 class ShapeLoader {
+    friend class ShapeCache;
+
 protected:
-    void loadBones(const aiMesh *aimesh);
-    void processNode(const aiNode *node, const aiScene *scene);
-    void processMesh(const aiMesh *aimesh, const aiScene *scene);
-    void loadTextures();
-    void genBuffers();
+    bool loadScene();
+    bool hasParam(uint param) const;
+    void optimizeMeshes();
+    void generateLods();
+    void buildMeshlets();
+    void computeBoundingSphere();
+    // adds bone to the shape if it isn't added yet
+    uint registerBone(const aiBone *bone);
+    void processNode(const aiNode *node, const aiScene *scene, std::vector<const aiMesh*> &aimeshes);
+
+    /**
+     * Imports meshes in two phases: computes vertex & index offsets of
+     * each mesh and allocates geometry once, then fills meshes in parallel
+     */
+    void processMeshes(const std::vector<const aiMesh*> &aimeshes, const aiScene *scene);
+
+    // creates mesh with material, geometry is filled by `processMeshes`
+    void processMesh(const aiMesh *aimesh, const aiScene *scene, usize start, usize count);
+
+    // CPU stage: can be executed on any thread
+    bool prepare();
+    void prepareTextures();
+    void prepareBuffers();
+    void prepareIndices();
+
+    // GL stage: must be executed on the GL thread
+    struct PendingTexture;
+    struct BufferData;
+    void uploadTexture(const PendingTexture &pendingTexture);
+    void uploadBuffer(const BufferData &bufferData);
+    void finishUpload();
+
+    // releases CPU copy of the geometry according to `m_geometryRetention`
+    void releaseGeometry();
 
 protected:
     struct MaterialTexPaths {
@@ -84,21 +238,34 @@ protected:
     };
 
     std::vector<MaterialTexPaths> m_materialTexPaths;
+    std::unordered_map<std::string, uint> m_bonesIndices; // bone name -> index in shape bones, exists only during import
     AMTLLoader *m_amtlLoader = nullptr; // NOTE: exists only during load()!
 
-    struct LoadedTexture {
+    // texture that is requested, but not created yet: images are decoded on
+    // the ThreadPool, textures are created & uploaded on the GL thread
+    struct PendingTexture {
         std::string path;
-        std::shared_ptr<Texture2D> texture;
         std::map<uint, uint> params;
+        uint sharedLevel;
+        usize imageIndex;
+        std::vector<std::shared_ptr<Texture2D>*> destinations;
+    };
 
-        LoadedTexture(const std::string &path, const std::shared_ptr<Texture2D> &texture,
-                const std::map<uint, uint> &params);
+    // buffer data prepared by the CPU stage
+    struct BufferData {
+        std::vector<ubyte> data;
+        ArrayBuffer **arrayBuffer; // destination, if not null
+        IndexBuffer **indexBuffer; // destination, if arrayBuffer is null
     };
 
-    std::vector<LoadedTexture> m_modelLoadedTextures;
-    static std::vector<LoadedTexture> m_globalLoadedTextures;
-    static int getLoadedTextureIndex(const std::vector<LoadedTexture> *loadedTextures, const std::string &path,
-            const std::map<uint, uint> &params);
+    std::vector<PendingTexture> m_pendingTextures;
+    std::vector<Image> m_images;
+    std::vector<std::vector<MipmapGenerator::Level>> m_mipmaps; // mip levels of m_images, starting from 1
+    std::vector<CompressedImage> m_compressedImages; // not empty if image is compressed
+    std::vector<BufferData> m_buffersData;
+
+    // Shared textures are stored in TextureCache::getDefault()
+    std::unordered_map<TextureCache::Key, std::shared_ptr<Texture2D>, TextureCache::KeyHash> m_modelLoadedTextures;
 
 public:
     enum Params {
@@ -106,18 +273,85 @@ public:
         SortByPolygonType,
         CalcTangentSpace,
         JoinIdenticalVertices,
-        InverseNormals
+        InverseNormals,
+        InterleaveBuffers, // store all vertex attributes in the one interleaved buffer
+        OptimizeMeshes, // reorder triangles & vertices for vertex cache, overdraw and vertex fetch
+        GenerateLods, // generate simplified levels of detail for each mesh
+        BuildMeshlets, // split meshes to meshlets with culling bounds
+        QuantizeVertices, // compact vertex format: unorm16 positions, octahedral snorm16 normals, half UVs
+        CompressTextures, // BC1/BC3 color maps, BC5 normal maps with mip chains, see `TextureCompressor`
+        QuantizeBones // ubyte ids & unorm8 weights (ushort & unorm16 if there are more than 256 bones)
+    };
+
+    // what part of `Shape::geometry` stays in RAM after buffers are prepared for uploading
+    enum GeometryRetention {
+        KeepAllGeometry,
+        KeepPositionsIndices, // e.g. for picking or collisions
+        ReleaseGeometry
     };
 
     ShapeLoader();
 
     void load();
 
+    /**
+     * Loads shape asynchronously: CPU stages are executed on the `ThreadPool`,
+     * GL uploads are pushed to `uploadQueue`, which must be processed by the GL thread.
+     * Loader must stay alive until the returned future is ready
+     * @return future, that becomes ready with the `load` result after the last upload
+     */
+    std::future<bool> loadAsync(GLUploadQueue *uploadQueue = GLUploadQueue::getDefault());
+
     void addParam(uint param);
     void setModelPath(const std::string &path);
     void setTexturesPath(const std::string &path);
+
+    /**
+     * Enables binary cache of the loaded shape (see `ShapeCache`).
+     * If the cache at `path` is up to date, Assimp import is skipped,
+     * otherwise it will be (re)created after loading. Empty path disables the cache
+     */
+    void setCachePath(const std::string &path);
+
+    /**
+     * Directory for the compressed textures (see `CompressTextures`), so
+     * each texture is compressed only once. Empty path disables the cache
+     */
+    void setTexturesCachePath(const std::string &path);
     void setDefaultTexturesParams(const std::map<uint, uint> &params);
 
+    /**
+     * Enables stages measurement, `stats` must be alive while loading. Null disables it
+     */
+    void setLoadStats(LoadStats *stats);
+
+    /**
+     * Reads model, AMTL and textures from the `pack` instead of files: model path
+     * and textures path are treated as entry names. Pack must be alive while loading
+     */
+    void setAssetPack(const AssetPack *pack);
+
+    /**
+     * Places interleaved vertices & indices to the shared `heap` instead of
+     * own buffers (see `GeometryHeap`). Works only with `InterleaveBuffers`
+     */
+    void setGeometryHeap(GeometryHeap *heap);
+
+    /**
+     * @param retention one of `GeometryRetention`, default is `KeepAllGeometry`
+     */
+    void setGeometryRetention(uint retention);
+
+    /**
+     * @return size in bytes of the geometry, released by the last `load`
+     */
+    usize getReleasedGeometrySize() const;
+
+    /**
+     * @return size in bytes, that `retention` policy would release from `geometry`
+     */
+    static usize getGeometrySavings(const Geometry &geometry, uint retention);
+
     template<typename...Args>
     void addParams(Args...args) {
         int params[] = {args...};
@@ -130,7 +364,12 @@ public:
 public:
     Shape *m_shape = nullptr;
     std::vector<uint> m_params;
-    std::string m_modelPath, m_texturesPath;
+    std::string m_modelPath, m_texturesPath, m_cachePath, m_texturesCachePath;
+    const AssetPack *m_assetPack = nullptr;
+    LoadStats *m_loadStats = nullptr;
+    GeometryHeap *m_geometryHeap = nullptr;
+    uint m_geometryRetention = KeepAllGeometry;
+    usize m_releasedGeometrySize = 0;
 
     std::map<uint, uint> m_defaultTexturesParams = std::map<uint, uint> {
             std::pair<uint, uint> {Texture::WrapU, Texture::Repeat},
@@ -6,6 +6,10 @@
 #include <string>
 #include <map>
 #include <algine/templates.h>
+#include <algine/Image.h>
+#include <algine/CompressedImage.h>
+#include <algine/MipmapGenerator.h>
+#include <vector>
 #include <tulz/macros.h>
 
 #define COLOR_ATTACHMENT(n) (GL_COLOR_ATTACHMENT0 + n)
@@ -102,6 +106,12 @@ public:
         RGBA32F = GL_RGBA32F,
     };
 
+    enum CompressedFormats {
+        BC1 = GL_COMPRESSED_RGB_S3TC_DXT1_EXT,
+        BC3 = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+        BC5 = GL_COMPRESSED_RG_RGTC2
+    };
+
     Texture();
     ~Texture();
 
@@ -150,6 +160,7 @@ public:
 protected:
     explicit Texture(uint target);
     void texFromFile(const std::string &path, uint target, uint dataType = GL_UNSIGNED_BYTE, bool flipImage = true);
+    void texFromImage(const Image &image, uint target, uint dataType = GL_UNSIGNED_BYTE);
 };
 
 class Texture2D: public Texture {
@@ -157,6 +168,26 @@ public:
     Texture2D();
 
     void fromFile(const std::string &path, uint dataType = GL_UNSIGNED_BYTE, bool flipImage = true);
+
+    // loads image entry `name` from the `pack`
+    void fromPack(const AssetPack &pack, const std::string &name, uint dataType = GL_UNSIGNED_BYTE, bool flipImage = true);
+
+    /**
+     * Uploads already decoded image, so decoding can be done on another thread
+     */
+    void fromImage(const Image &image, uint dataType = GL_UNSIGNED_BYTE);
+
+    /**
+     * Uploads image with its mip chain generated on the CPU, so glGenerateMipmap is not called.
+     * Uses immutable storage if ARB_texture_storage is available, so `format` must be sized
+     * @param mipmaps levels starting from 1, see `MipmapGenerator`
+     */
+    void fromImage(const Image &image, const std::vector<MipmapGenerator::Level> &mipmaps);
+
+    /**
+     * Uploads all levels of the block compressed image, `format` becomes compressed format
+     */
+    void fromCompressedImage(const CompressedImage &image);
     void update() override;
 
     /**
@@ -114,7 +114,22 @@ bool AMTLLoader::load(const std::string &path) {
         return false;
     }
 
-    nlohmann::json json = nlohmann::json::parse(File(path, File::Read).readStr());
+    return parse(File(path, File::Read).readStr());
+}
+
+bool AMTLLoader::load(const AssetPack &pack, const std::string &name) {
+    std::string str;
+
+    if (!pack.readString(name, str)) {
+        std::cout << "AMTLLoader::load(): " << name << " not found in " << pack.getPath() << "\n";
+        return false;
+    }
+
+    return parse(str);
+}
+
+bool AMTLLoader::parse(const std::string &str) {
+    nlohmann::json json = nlohmann::json::parse(str);
 
     for (auto materialJSONObject : json) {
         string name = materialJSONObject[AMTL::Name];
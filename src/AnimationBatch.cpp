@@ -0,0 +1,66 @@
+#include <algine/AnimationBatch.h>
+
+#include <algorithm>
+
+using namespace std;
+
+namespace algine {
+AnimationBatch::AnimationBatch(ThreadPool *pool): m_pool(pool) { /* empty */ }
+
+AnimationBatch::~AnimationBatch() {
+    finish();
+}
+
+void AnimationBatch::add(Model *model) {
+    finish();
+    m_models.push_back(model);
+}
+
+void AnimationBatch::remove(Model *model) {
+    finish();
+    m_models.erase(std::remove(m_models.begin(), m_models.end(), model), m_models.end());
+}
+
+void AnimationBatch::clear() {
+    finish();
+    m_models.clear();
+}
+
+void AnimationBatch::begin(const float timeInSeconds) {
+    finish();
+
+    for (Model *model : m_models) {
+        if (model->animator == nullptr)
+            continue;
+
+        m_tasks.push_back(m_pool->submit([model, timeInSeconds]() {
+            model->animateBack(timeInSeconds);
+        }));
+    }
+}
+
+void AnimationBatch::finish() {
+    if (m_tasks.empty())
+        return;
+
+    for (auto &task : m_tasks)
+        m_pool->wait(task);
+
+    m_tasks.clear();
+
+    for (Model *model : m_models) {
+        if (model->animator != nullptr) {
+            model->swapPalettes();
+        }
+    }
+}
+
+void AnimationBatch::animate(const float timeInSeconds) {
+    begin(timeInSeconds);
+    finish();
+}
+
+bool AnimationBatch::isRunning() const {
+    return !m_tasks.empty();
+}
+}
@@ -0,0 +1,202 @@
+#include <algine/AssetPack.h>
+#include <algine/LZ4.h>
+
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+namespace algine {
+constexpr uint AssetPack::Version;
+constexpr uint AssetPack::Magic;
+constexpr uint AssetPack::Alignment;
+
+AssetPack::AssetPack() = default;
+
+AssetPack::AssetPack(const string &path) {
+    open(path);
+}
+
+bool AssetPack::open(const string &path) {
+    close();
+
+    if (!m_file.open(path)) {
+        cerr << "AssetPack: can't open " << path << "\n";
+        return false;
+    }
+
+    const ubyte *data = m_file.getData();
+    usize size = m_file.getSize();
+    Header header;
+
+    if (size < sizeof(Header)) {
+        cerr << "AssetPack: " << path << " is too small\n";
+        close();
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(Header));
+
+    if (header.magic != Magic || header.version != Version ||
+        header.indexOffset > size || header.indexSize > size - header.indexOffset)
+    {
+        cerr << "AssetPack: " << path << " has invalid header or unsupported version\n";
+        close();
+        return false;
+    }
+
+    const ubyte *pos = data + header.indexOffset;
+    const ubyte *end = pos + header.indexSize;
+
+    for (uint i = 0; i < header.entriesCount; i++) {
+        Entry entry;
+        uint nameLength;
+
+        constexpr usize recordSize = 3 * sizeof(uint64) + 2 * sizeof(uint);
+
+        if (static_cast<usize>(end - pos) < recordSize)
+            break;
+
+        memcpy(&entry.offset, pos, sizeof(uint64));
+        memcpy(&entry.storedSize, pos + 8, sizeof(uint64));
+        memcpy(&entry.size, pos + 16, sizeof(uint64));
+        memcpy(&entry.flags, pos + 24, sizeof(uint));
+        memcpy(&nameLength, pos + 28, sizeof(uint));
+        pos += recordSize;
+
+        if (static_cast<usize>(end - pos) < nameLength ||
+            entry.offset > size || entry.storedSize > size - entry.offset)
+        {
+            break;
+        }
+
+        m_entries[string(reinterpret_cast<const char*>(pos), nameLength)] = entry;
+        pos += nameLength;
+    }
+
+    if (m_entries.size() != header.entriesCount) {
+        cerr << "AssetPack: " << path << " has corrupted index\n";
+        close();
+        return false;
+    }
+
+    m_path = path;
+
+    return true;
+}
+
+void AssetPack::close() {
+    m_file.close();
+    m_entries.clear();
+    m_path.clear();
+}
+
+bool AssetPack::isOpen() const {
+    return m_file.isOpen();
+}
+
+bool AssetPack::exists(const string &name) const {
+    return getEntry(name) != nullptr;
+}
+
+const AssetPack::Entry* AssetPack::getEntry(const string &name) const {
+    auto it = m_entries.find(toEntryName(name));
+    return it != m_entries.end() ? &it->second : nullptr;
+}
+
+bool AssetPack::read(const string &name, const ubyte *&data, usize &size, vector<ubyte> &buffer) const {
+    const Entry *entry = getEntry(name);
+
+    if (entry == nullptr)
+        return false;
+
+    const ubyte *stored = m_file.getData() + entry->offset;
+
+    if ((entry->flags & Compressed) == 0) {
+        data = stored;
+        size = entry->storedSize;
+        return true;
+    }
+
+    // LZ4 block expands data at most 255 times, larger size means corrupted index
+    if (entry->size / 255 > entry->storedSize) {
+        cerr << "AssetPack: invalid size of " << name << " in " << m_path << "\n";
+        return false;
+    }
+
+    buffer.resize(entry->size);
+
+    if (!LZ4::decompress(stored, entry->storedSize, buffer.data(), buffer.size())) {
+        cerr << "AssetPack: can't decompress " << name << " from " << m_path << "\n";
+        return false;
+    }
+
+    data = buffer.data();
+    size = buffer.size();
+
+    return true;
+}
+
+bool AssetPack::readString(const string &name, string &str) const {
+    const ubyte *data;
+    usize size;
+    vector<ubyte> buffer;
+
+    if (!read(name, data, size, buffer))
+        return false;
+
+    str.assign(reinterpret_cast<const char*>(data), size);
+
+    return true;
+}
+
+const string& AssetPack::getPath() const {
+    return m_path;
+}
+
+vector<string> AssetPack::getNames() const {
+    vector<string> names;
+    names.reserve(m_entries.size());
+
+    for (const auto &entry : m_entries)
+        names.push_back(entry.first);
+
+    return names;
+}
+
+string AssetPack::toEntryName(const string &path) {
+    vector<string> parts;
+    usize begin = 0;
+
+    while (begin <= path.size()) {
+        usize end = path.find_first_of("/\\", begin);
+
+        if (end == string::npos)
+            end = path.size();
+
+        string part = path.substr(begin, end - begin);
+
+        if (part == "..") {
+            if (!parts.empty() && parts.back() != "..") {
+                parts.pop_back();
+            } else {
+                parts.push_back(part);
+            }
+        } else if (!part.empty() && part != ".") {
+            parts.push_back(part);
+        }
+
+        begin = end + 1;
+    }
+
+    string name;
+
+    for (usize i = 0; i < parts.size(); i++) {
+        if (i != 0)
+            name += '/';
+        name += parts[i];
+    }
+
+    return name;
+}
+}
@@ -0,0 +1,147 @@
+#include <algine/AssetPackWriter.h>
+#include <algine/AssetPack.h>
+#include <algine/LZ4.h>
+
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+
+using namespace std;
+
+namespace algine {
+void AssetPackWriter::add(const string &name, const vector<ubyte> &data, const bool compress) {
+    PendingEntry entry;
+    entry.name = AssetPack::toEntryName(name);
+    entry.size = data.size();
+    entry.flags = 0;
+
+    if (compress && !data.empty()) {
+        LZ4::compress(data.data(), data.size(), entry.data);
+
+        if (entry.data.size() < data.size()) {
+            entry.flags |= AssetPack::Compressed;
+        } else {
+            entry.data.clear();
+        }
+    }
+
+    if ((entry.flags & AssetPack::Compressed) == 0)
+        entry.data = data;
+
+    // replacing entry with the same name
+    for (PendingEntry &pendingEntry : m_entries) {
+        if (pendingEntry.name == entry.name) {
+            pendingEntry = move(entry);
+            return;
+        }
+    }
+
+    m_entries.push_back(move(entry));
+}
+
+bool AssetPackWriter::addFile(const string &path, const bool compress) {
+    ifstream in(path, ios::binary | ios::ate);
+
+    if (!in.is_open()) {
+        cerr << "AssetPackWriter: can't open " << path << "\n";
+        return false;
+    }
+
+    vector<ubyte> data(static_cast<usize>(in.tellg()));
+    in.seekg(0);
+
+    if (!in.read(reinterpret_cast<char*>(data.data()), data.size())) {
+        cerr << "AssetPackWriter: can't read " << path << "\n";
+        return false;
+    }
+
+    add(path, data, compress);
+
+    return true;
+}
+
+inline void align(ofstream &out) {
+    static const char zeros[AssetPack::Alignment] {};
+    auto pos = static_cast<uint64>(out.tellp());
+    out.write(zeros, (AssetPack::Alignment - pos % AssetPack::Alignment) % AssetPack::Alignment);
+}
+
+template<typename T>
+inline void write(ofstream &out, const T &value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+bool AssetPackWriter::save(const string &path) const {
+    // pack is written to the temporary file, so readers never see a partial pack
+    string tmpPath = path + ".tmp";
+    ofstream out(tmpPath, ios::binary | ios::trunc);
+
+    if (!out.is_open()) {
+        cerr << "AssetPackWriter: can't open " << tmpPath << " for writing\n";
+        return false;
+    }
+
+    AssetPack::Header header;
+    header.entriesCount = m_entries.size();
+    write(out, header);
+
+    vector<uint64> offsets(m_entries.size());
+
+    for (usize i = 0; i < m_entries.size(); i++) {
+        align(out);
+        offsets[i] = static_cast<uint64>(out.tellp());
+        out.write(reinterpret_cast<const char*>(m_entries[i].data.data()), m_entries[i].data.size());
+    }
+
+    header.indexOffset = static_cast<uint64>(out.tellp());
+
+    for (usize i = 0; i < m_entries.size(); i++) {
+        const PendingEntry &entry = m_entries[i];
+        write<uint64>(out, offsets[i]);
+        write<uint64>(out, entry.data.size());
+        write<uint64>(out, entry.size);
+        write<uint>(out, entry.flags);
+        write<uint>(out, entry.name.size());
+        out.write(entry.name.data(), entry.name.size());
+    }
+
+    header.indexSize = static_cast<uint64>(out.tellp()) - header.indexOffset;
+
+    out.seekp(0);
+    write(out, header);
+    out.close();
+
+    if (!out) {
+        cerr << "AssetPackWriter: can't write " << tmpPath << "\n";
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    remove(path.c_str()); // rename fails on Windows if the destination exists
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        cerr << "AssetPackWriter: can't rename " << tmpPath << " to " << path << "\n";
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+uint64 AssetPackWriter::getSize() const {
+    uint64 size = 0;
+
+    for (const PendingEntry &entry : m_entries)
+        size += entry.size;
+
+    return size;
+}
+
+uint64 AssetPackWriter::getStoredSize() const {
+    uint64 size = 0;
+
+    for (const PendingEntry &entry : m_entries)
+        size += entry.data.size();
+
+    return size;
+}
+}
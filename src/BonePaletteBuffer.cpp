@@ -0,0 +1,57 @@
+#include <algine/BonePaletteBuffer.h>
+
+#include <algorithm>
+
+namespace algine {
+BonePaletteBuffer::BonePaletteBuffer(const uint bonesCount)
+    : Buffer(GL_TEXTURE_BUFFER),
+      m_capacity(std::max(bonesCount, 1u))
+{
+    bind();
+    setData(m_capacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    unbind();
+
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_id);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+BonePaletteBuffer::~BonePaletteBuffer() {
+    glDeleteTextures(1, &m_texture);
+}
+
+void BonePaletteBuffer::begin() {
+    m_staging.clear();
+}
+
+uint BonePaletteBuffer::add(const std::vector<glm::mat4> &palette) {
+    auto offset = static_cast<uint>(m_staging.size());
+    m_staging.insert(m_staging.end(), palette.begin(), palette.end());
+
+    return offset;
+}
+
+void BonePaletteBuffer::end() {
+    if (m_staging.empty())
+        return;
+
+    m_capacity = std::max(m_capacity, static_cast<uint>(m_staging.size()));
+
+    // orphaning: the driver allocates new storage, so the upload doesn't wait
+    // for the draws of the previous frames, which keep the old one
+    bind();
+    setData(m_capacity * sizeof(glm::mat4), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, m_staging.size() * sizeof(glm::mat4), m_staging.data());
+    unbind();
+}
+
+void BonePaletteBuffer::use(const uint slot) const {
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_BUFFER, m_texture);
+}
+
+uint BonePaletteBuffer::getTexture() const {
+    return m_texture;
+}
+}
@@ -0,0 +1,139 @@
+#include <algine/CompressedImage.h>
+
+#include <sys/stat.h>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <functional>
+#include <cstdio>
+
+using namespace std;
+
+namespace algine {
+constexpr uint imageMagic = 0x43544141; // "AATC"
+constexpr uint imageVersion = 2;
+
+// levels larger than this are treated as corrupted data
+constexpr uint maxLevelSize = 1u << 30u;
+
+struct SourceInfo {
+    int64 mtime = -1;
+    uint64 size = 0;
+
+    explicit SourceInfo(const string &path) {
+        struct stat fileStat {};
+        if (stat(path.c_str(), &fileStat) == 0) {
+            mtime = static_cast<int64>(fileStat.st_mtime);
+            size = static_cast<uint64>(fileStat.st_size);
+        }
+    }
+};
+
+template<typename T>
+inline bool readValue(ifstream &in, T &value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template<typename T>
+inline void writeValue(ofstream &out, const T &value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+bool CompressedImage::load(const string &path, const string &sourcePath) {
+    ifstream in(path, ios::binary);
+
+    if (!in.is_open())
+        return false;
+
+    SourceInfo source(sourcePath);
+    uint magic = 0, version = 0, levelsCount = 0;
+    int64 mtime = 0;
+    uint64 size = 0;
+
+    if (!readValue(in, magic) || magic != imageMagic ||
+        !readValue(in, version) || version != imageVersion ||
+        !readValue(in, mtime) || mtime != source.mtime ||
+        !readValue(in, size) || size != source.size ||
+        !readValue(in, format) ||
+        !readValue(in, levelsCount))
+    {
+        return false;
+    }
+
+    levels.resize(levelsCount);
+
+    for (Level &level : levels) {
+        uint dataSize = 0;
+
+        if (!readValue(in, level.width) || !readValue(in, level.height) ||
+            !readValue(in, dataSize) || dataSize > maxLevelSize)
+        {
+            levels.clear();
+            return false;
+        }
+
+        level.data.resize(dataSize);
+
+        if (!in.read(reinterpret_cast<char*>(level.data.data()), dataSize)) {
+            levels.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool CompressedImage::save(const string &path, const string &sourcePath) const {
+    // loaders sharing a texture may save it simultaneously, so each thread writes
+    // own temporary file and readers never see a partially written image
+    string tmpPath = path + ".tmp" + to_string(hash<thread::id>()(this_thread::get_id()));
+    ofstream out(tmpPath, ios::binary | ios::trunc);
+
+    if (!out.is_open()) {
+        std::cerr << "Can't write compressed image " << tmpPath << "\n";
+        return false;
+    }
+
+    SourceInfo source(sourcePath);
+
+    writeValue(out, imageMagic);
+    writeValue(out, imageVersion);
+    writeValue(out, source.mtime);
+    writeValue(out, source.size);
+    writeValue(out, format);
+    writeValue<uint>(out, levels.size());
+
+    for (const Level &level : levels) {
+        writeValue(out, level.width);
+        writeValue(out, level.height);
+        writeValue<uint>(out, level.data.size());
+        out.write(reinterpret_cast<const char*>(level.data.data()), level.data.size());
+    }
+
+    out.close();
+
+    if (out.fail()) {
+        std::cerr << "Can't write compressed image " << tmpPath << "\n";
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    remove(path.c_str()); // rename fails on Windows if the destination exists
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Can't rename " << tmpPath << " to " << path << "\n";
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+usize CompressedImage::getSize() const {
+    usize size = 0;
+
+    for (const Level &level : levels)
+        size += level.data.size();
+
+    return size;
+}
+}
@@ -0,0 +1,88 @@
+#include <algine/FreeListAllocator.h>
+
+#include <iterator>
+
+namespace algine {
+FreeListAllocator::FreeListAllocator(const uint capacity) {
+    grow(capacity);
+}
+
+bool FreeListAllocator::allocate(const uint size, const uint alignment, Range &range) {
+    if (size == 0) {
+        range = Range();
+        return true;
+    }
+
+    for (auto block = m_free.begin(); block != m_free.end(); ++block) {
+        uint offset = block->first, blockSize = block->second;
+        uint padding = alignment > 1 ? (alignment - offset % alignment) % alignment : 0;
+
+        if (blockSize < padding || blockSize - padding < size)
+            continue;
+
+        m_free.erase(block);
+        m_freeSize -= blockSize;
+
+        // the rest of the block stays free
+        if (padding != 0)
+            addFree(offset, padding);
+
+        if (blockSize - padding > size)
+            addFree(offset + padding + size, blockSize - padding - size);
+
+        range.offset = offset + padding;
+        range.size = size;
+
+        return true;
+    }
+
+    return false;
+}
+
+void FreeListAllocator::free(const Range &range) {
+    if (range.size != 0)
+        addFree(range.offset, range.size);
+}
+
+void FreeListAllocator::grow(const uint capacity) {
+    if (capacity <= m_capacity)
+        return;
+
+    uint oldCapacity = m_capacity;
+    m_capacity = capacity;
+
+    addFree(oldCapacity, capacity - oldCapacity);
+}
+
+uint FreeListAllocator::getCapacity() const {
+    return m_capacity;
+}
+
+uint FreeListAllocator::getFreeSize() const {
+    return m_freeSize;
+}
+
+void FreeListAllocator::addFree(uint offset, uint size) {
+    m_freeSize += size;
+
+    // merging with the next free range
+    auto next = m_free.lower_bound(offset);
+
+    if (next != m_free.end() && next->first == offset + size) {
+        size += next->second;
+        next = m_free.erase(next);
+    }
+
+    // merging with the previous free range
+    if (next != m_free.begin()) {
+        auto prev = std::prev(next);
+
+        if (prev->first + prev->second == offset) {
+            prev->second += size;
+            return;
+        }
+    }
+
+    m_free[offset] = size;
+}
+}
@@ -0,0 +1,62 @@
+#include <algine/GLUploadQueue.h>
+
+#include <chrono>
+
+namespace algine {
+void GLUploadQueue::push(const std::function<void()> &task) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push(task);
+}
+
+uint GLUploadQueue::process(const double timeBudget) {
+    using namespace std::chrono;
+
+    auto start = steady_clock::now();
+    std::function<void()> task;
+    uint count = 0;
+
+    while (pop(task)) {
+        task();
+        count++;
+
+        if (duration<double>(steady_clock::now() - start).count() >= timeBudget)
+            break;
+    }
+
+    return count;
+}
+
+uint GLUploadQueue::processAll() {
+    std::function<void()> task;
+    uint count = 0;
+
+    while (pop(task)) {
+        task();
+        count++;
+    }
+
+    return count;
+}
+
+bool GLUploadQueue::isEmpty() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_tasks.empty();
+}
+
+GLUploadQueue* GLUploadQueue::getDefault() {
+    static GLUploadQueue queue;
+    return &queue;
+}
+
+bool GLUploadQueue::pop(std::function<void()> &task) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_tasks.empty())
+        return false;
+
+    task = std::move(m_tasks.front());
+    m_tasks.pop();
+
+    return true;
+}
+}
@@ -0,0 +1,199 @@
+#include <algine/GeometryHeap.h>
+
+#include <GL/glew.h>
+#include <algorithm>
+
+using namespace std;
+
+namespace algine {
+inline bool isSameFormat(const Shape::VertexAttribFormat &a, const Shape::VertexAttribFormat &b) {
+    return a.count == b.count && a.type == b.type && a.normalized == b.normalized &&
+           a.size == b.size && a.offset == b.offset;
+}
+
+inline bool isSameFormat(const Shape::VertexFormat &a, const Shape::VertexFormat &b) {
+    return a.stride == b.stride && a.octahedral == b.octahedral &&
+           isSameFormat(a.vertices, b.vertices) && isSameFormat(a.normals, b.normals) &&
+           isSameFormat(a.texCoords, b.texCoords) && isSameFormat(a.tangents, b.tangents) &&
+           isSameFormat(a.bitangents, b.bitangents) && isSameFormat(a.boneWeights, b.boneWeights) &&
+           isSameFormat(a.boneIds, b.boneIds);
+}
+
+inline void createStorage(Buffer *buffer, const uint size) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer->m_id);
+    glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+/**
+ * Recreates buffer storage with `newSize` bytes, keeping the first `oldSize` bytes.
+ * Buffer object stays the same, so shapes can keep pointers to it, but VAOs must be updated
+ */
+inline void growStorage(Buffer *buffer, const uint oldSize, const uint newSize) {
+    uint newId;
+    glGenBuffers(1, &newId);
+
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer->m_id);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newId);
+    glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    glDeleteBuffers(1, &buffer->m_id);
+    buffer->m_id = newId;
+}
+
+// uses copy target, so element array binding of the bound VAO isn't changed
+inline void uploadData(Buffer *buffer, const uint offset, const vector<ubyte> &data) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer->m_id);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, offset, data.size(), data.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+// allocates range, growing allocator 2 times until it fits
+inline void allocateGrowing(FreeListAllocator &allocator, const uint size, const uint alignment,
+        FreeListAllocator::Range &range, uint &oldCapacity)
+{
+    oldCapacity = allocator.getCapacity();
+
+    while (!allocator.allocate(size, alignment, range))
+        allocator.grow(std::max(allocator.getCapacity() * 2, size + alignment));
+}
+
+GeometryHeap::GeometryHeap(const uint vertexPoolSize, const uint indexPoolSize)
+    : m_indicesAllocator(indexPoolSize),
+      m_vertexPoolSize(vertexPoolSize)
+{
+    m_indices = new IndexBuffer();
+    createStorage(m_indices, indexPoolSize);
+}
+
+GeometryHeap::~GeometryHeap() {
+    for (auto &pool : m_vertexPools) {
+        for (auto &vao : pool->vaos)
+            glDeleteVertexArrays(1, &vao.second);
+
+        delete pool->buffer;
+    }
+
+    delete m_indices;
+}
+
+void GeometryHeap::addVertices(Shape &shape, const vector<ubyte> &data) {
+    VertexPool *pool = getPool(shape.vertexFormat, true);
+    uint stride = shape.vertexFormat.stride;
+    uint oldCapacity;
+
+    allocateGrowing(pool->allocator, data.size() / stride, 1, shape.vertexRange, oldCapacity);
+
+    if (pool->allocator.getCapacity() != oldCapacity) {
+        growStorage(pool->buffer, oldCapacity * stride, pool->allocator.getCapacity() * stride);
+
+        for (auto &vao : pool->vaos) {
+            setupVAO(vao.second, *pool, vao.first);
+        }
+    }
+
+    uploadData(pool->buffer, shape.vertexRange.offset * stride, data);
+
+    for (Mesh &mesh : shape.meshes)
+        mesh.baseVertex += shape.vertexRange.offset;
+
+    shape.heap = this;
+    shape.buffers.interleaved = pool->buffer;
+}
+
+void GeometryHeap::addIndices(Shape &shape, const vector<ubyte> &data) {
+    uint oldCapacity;
+
+    // 4 bytes alignment suits both 16 and 32 bit indices
+    allocateGrowing(m_indicesAllocator, data.size(), sizeof(uint), shape.indexRange, oldCapacity);
+
+    if (m_indicesAllocator.getCapacity() != oldCapacity) {
+        growStorage(m_indices, oldCapacity, m_indicesAllocator.getCapacity());
+
+        // element array buffer binding is a part of the VAO state
+        for (auto &pool : m_vertexPools) {
+            for (auto &vao : pool->vaos) {
+                setupVAO(vao.second, *pool, vao.first);
+            }
+        }
+    }
+
+    uploadData(m_indices, shape.indexRange.offset, data);
+
+    for (Mesh &mesh : shape.meshes)
+        mesh.indicesByteOffset = shape.indexRange.offset;
+
+    shape.heap = this;
+    shape.buffers.indices = m_indices;
+}
+
+void GeometryHeap::remove(Shape &shape) {
+    VertexPool *pool = getPool(shape.vertexFormat, false);
+
+    if (pool != nullptr)
+        pool->allocator.free(shape.vertexRange);
+
+    m_indicesAllocator.free(shape.indexRange);
+
+    for (Mesh &mesh : shape.meshes) {
+        mesh.baseVertex -= shape.vertexRange.offset;
+        mesh.indicesByteOffset = 0;
+    }
+
+    shape.vertexRange = FreeListAllocator::Range();
+    shape.indexRange = FreeListAllocator::Range();
+    shape.buffers.interleaved = nullptr;
+    shape.buffers.indices = nullptr;
+    shape.vaos.clear();
+    shape.heap = nullptr;
+}
+
+uint GeometryHeap::getVAO(const Shape &shape, const Shape::AttribLocations &locations) {
+    VertexPool *pool = getPool(shape.vertexFormat, true);
+
+    for (auto &vao : pool->vaos)
+        if (vao.first == locations)
+            return vao.second;
+
+    uint vao;
+    glGenVertexArrays(1, &vao);
+    setupVAO(vao, *pool, locations);
+    pool->vaos.emplace_back(locations, vao);
+
+    return vao;
+}
+
+GeometryHeap::VertexPool* GeometryHeap::getPool(const Shape::VertexFormat &format, const bool create) {
+    for (auto &pool : m_vertexPools)
+        if (isSameFormat(pool->format, format))
+            return pool.get();
+
+    if (!create)
+        return nullptr;
+
+    uint capacity = std::max(m_vertexPoolSize / format.stride, 1u);
+
+    m_vertexPools.emplace_back(new VertexPool());
+    VertexPool *pool = m_vertexPools.back().get();
+    pool->format = format;
+    pool->buffer = new ArrayBuffer();
+    pool->allocator.grow(capacity);
+    createStorage(pool->buffer, capacity * format.stride);
+
+    return pool;
+}
+
+void GeometryHeap::setupVAO(const uint vao, const VertexPool &pool, const Shape::AttribLocations &locations) {
+    Shape::Buffers buffers;
+    buffers.interleaved = pool.buffer;
+
+    glBindVertexArray(vao);
+    Shape::setAttribPointers(pool.format, buffers, locations);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_indices->bind();
+    glBindVertexArray(0);
+}
+}
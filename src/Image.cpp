@@ -0,0 +1,96 @@
+#include <algine/Image.h>
+#include <algine/texture.h>
+
+#include <stb/stb_image.h>
+#include <iostream>
+#include <utility>
+
+namespace algine {
+Image::Image() = default;
+
+Image::~Image() {
+    free();
+}
+
+Image::Image(Image &&src) noexcept {
+    std::swap(data, src.data);
+    std::swap(width, src.width);
+    std::swap(height, src.height);
+    std::swap(channels, src.channels);
+}
+
+Image& Image::operator=(Image &&rhs) noexcept {
+    std::swap(data, rhs.data);
+    std::swap(width, rhs.width);
+    std::swap(height, rhs.height);
+    std::swap(channels, rhs.channels);
+    return *this;
+}
+
+bool Image::fromFile(const std::string &path, const bool flipImage) {
+    free();
+
+    // thread local flag: images can be decoded simultaneously on different threads
+    stbi_set_flip_vertically_on_load_thread(flipImage);
+
+    int w, h, c;
+    data = stbi_load(path.c_str(), &w, &h, &c, 0);
+
+    if (!data) {
+        std::cerr << "Failed to load image " << path << ": " << stbi_failure_reason() << "\n";
+        return false;
+    }
+
+    width = w;
+    height = h;
+    channels = c;
+
+    return true;
+}
+
+bool Image::fromMemory(const ubyte *encoded, const usize size, const bool flipImage) {
+    free();
+
+    stbi_set_flip_vertically_on_load_thread(flipImage);
+
+    int w, h, c;
+    data = stbi_load_from_memory(encoded, static_cast<int>(size), &w, &h, &c, 0);
+
+    if (!data) {
+        std::cerr << "Failed to decode image: " << stbi_failure_reason() << "\n";
+        return false;
+    }
+
+    width = w;
+    height = h;
+    channels = c;
+
+    return true;
+}
+
+bool Image::fromPack(const AssetPack &pack, const std::string &name, const bool flipImage) {
+    const ubyte *encoded;
+    usize size;
+    std::vector<ubyte> buffer;
+
+    if (!pack.read(name, encoded, size, buffer)) {
+        std::cerr << "Failed to load image " << name << ": not found in " << pack.getPath() << "\n";
+        return false;
+    }
+
+    return fromMemory(encoded, size, flipImage);
+}
+
+void Image::free() {
+    if (data)
+        stbi_image_free(data);
+
+    data = nullptr;
+    width = height = channels = 0;
+}
+
+uint Image::getDataFormat() const {
+    static const uint formats[] = {Texture::Red, Texture::RG, Texture::RGB, Texture::RGBA};
+    return channels >= 1 && channels <= 4 ? formats[channels - 1] : static_cast<uint>(Texture::RGB);
+}
+}
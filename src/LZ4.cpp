@@ -0,0 +1,168 @@
+#include <algine/LZ4.h>
+
+#include <cstring>
+
+using namespace std;
+
+namespace algine {
+constexpr uint minMatch = 4;
+constexpr uint lastLiterals = 5; // the last 5 bytes are always literals
+constexpr uint matchFindLimit = 12; // the last match must start at least 12 bytes before the end
+constexpr uint maxOffset = 65535;
+constexpr uint hashLog = 16;
+
+inline uint read32(const ubyte *p) {
+    uint value;
+    memcpy(&value, p, sizeof(uint));
+    return value;
+}
+
+inline uint hash32(const uint value) {
+    return (value * 2654435761u) >> (32u - hashLog);
+}
+
+// 15 in the token nibble, then 255 bytes while length remains
+inline void writeLength(vector<ubyte> &dst, usize length) {
+    while (length >= 255) {
+        dst.push_back(255);
+        length -= 255;
+    }
+
+    dst.push_back(static_cast<ubyte>(length));
+}
+
+inline void writeSequence(vector<ubyte> &dst, const ubyte *literals, const usize literalsCount,
+        const uint offset, const usize matchLength)
+{
+    ubyte token = static_cast<ubyte>((literalsCount < 15 ? literalsCount : 15) << 4u);
+
+    if (offset != 0) {
+        usize length = matchLength - minMatch;
+        token |= static_cast<ubyte>(length < 15 ? length : 15);
+    }
+
+    dst.push_back(token);
+
+    if (literalsCount >= 15)
+        writeLength(dst, literalsCount - 15);
+
+    dst.insert(dst.end(), literals, literals + literalsCount);
+
+    // the last sequence contains only literals
+    if (offset == 0)
+        return;
+
+    dst.push_back(static_cast<ubyte>(offset & 0xffu));
+    dst.push_back(static_cast<ubyte>(offset >> 8u));
+
+    if (matchLength - minMatch >= 15) {
+        writeLength(dst, matchLength - minMatch - 15);
+    }
+}
+
+void LZ4::compress(const ubyte *src, const usize size, vector<ubyte> &dst) {
+    vector<uint> table(1u << hashLog, 0); // hash -> position
+    usize pos = 0, anchor = 0;
+
+    dst.reserve(dst.size() + size + size / 255 + 16);
+
+    while (size > matchFindLimit && pos + matchFindLimit < size) {
+        uint sequence = read32(src + pos);
+        uint &entry = table[hash32(sequence)];
+        usize candidate = entry;
+        entry = static_cast<uint>(pos);
+
+        if (candidate >= pos || pos - candidate > maxOffset || read32(src + candidate) != sequence) {
+            ++pos;
+            continue;
+        }
+
+        usize matchLength = minMatch;
+        usize limit = size - lastLiterals;
+
+        while (pos + matchLength < limit && src[candidate + matchLength] == src[pos + matchLength])
+            ++matchLength;
+
+        // extending match backwards
+        while (pos > anchor && candidate > 0 && src[pos - 1] == src[candidate - 1]) {
+            --pos;
+            --candidate;
+            ++matchLength;
+        }
+
+        writeSequence(dst, src + anchor, pos - anchor, static_cast<uint>(pos - candidate), matchLength);
+
+        pos += matchLength;
+        anchor = pos;
+    }
+
+    writeSequence(dst, src + anchor, size - anchor, 0, 0);
+}
+
+// reads length continuation bytes
+inline bool readLength(const ubyte *src, const usize srcSize, usize &pos, usize &length) {
+    ubyte value;
+
+    do {
+        if (pos >= srcSize)
+            return false;
+
+        value = src[pos++];
+        length += value;
+    } while (value == 255);
+
+    return true;
+}
+
+bool LZ4::decompress(const ubyte *src, const usize srcSize, ubyte *dst, const usize dstSize) {
+    usize srcPos = 0, dstPos = 0;
+
+    while (srcPos < srcSize) {
+        ubyte token = src[srcPos++];
+        usize literalsCount = token >> 4u;
+
+        if (literalsCount == 15 && !readLength(src, srcSize, srcPos, literalsCount))
+            return false;
+
+        if (literalsCount > srcSize - srcPos || literalsCount > dstSize - dstPos)
+            return false;
+
+        memcpy(dst + dstPos, src + srcPos, literalsCount);
+        srcPos += literalsCount;
+        dstPos += literalsCount;
+
+        // the last sequence
+        if (srcPos == srcSize)
+            break;
+
+        if (srcSize - srcPos < 2)
+            return false;
+
+        usize offset = src[srcPos] | (static_cast<usize>(src[srcPos + 1]) << 8u);
+        srcPos += 2;
+
+        if (offset == 0 || offset > dstPos)
+            return false;
+
+        usize matchLength = token & 0xfu;
+
+        if (matchLength == 15 && !readLength(src, srcSize, srcPos, matchLength))
+            return false;
+
+        matchLength += minMatch;
+
+        if (matchLength > dstSize - dstPos)
+            return false;
+
+        // match can overlap the output, so it's copied byte by byte
+        const ubyte *match = dst + dstPos - offset;
+
+        for (usize i = 0; i < matchLength; i++)
+            dst[dstPos + i] = match[i];
+
+        dstPos += matchLength;
+    }
+
+    return dstPos == dstSize;
+}
+}
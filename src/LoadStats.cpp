@@ -0,0 +1,67 @@
+#include <algine/LoadStats.h>
+
+using namespace std;
+
+namespace algine {
+LoadStats::AllocationsInfo (*LoadStats::allocationsCounter)() = nullptr;
+
+LoadStats::Scope::Scope(LoadStats *stats, const uint stage): m_stats(stats), m_stage(stage) {
+    if (m_stats != nullptr)
+        m_stats->begin(m_stage);
+}
+
+LoadStats::Scope::~Scope() {
+    if (m_stats != nullptr)
+        m_stats->end(m_stage);
+}
+
+void LoadStats::begin(const uint stage) {
+    if (allocationsCounter != nullptr)
+        m_beginAllocations[stage] = allocationsCounter();
+
+    m_beginTime[stage] = chrono::steady_clock::now();
+}
+
+void LoadStats::end(const uint stage) {
+    auto endTime = chrono::steady_clock::now();
+    Stage &result = m_stages[stage];
+
+    result.time += chrono::duration<double, milli>(endTime - m_beginTime[stage]).count();
+    result.calls++;
+
+    if (allocationsCounter != nullptr) {
+        AllocationsInfo allocations = allocationsCounter();
+        result.allocations += allocations.allocations - m_beginAllocations[stage].allocations;
+        result.allocatedBytes += allocations.allocatedBytes - m_beginAllocations[stage].allocatedBytes;
+    }
+}
+
+void LoadStats::reset() {
+    for (Stage &stage : m_stages) {
+        stage = Stage();
+    }
+}
+
+const LoadStats::Stage& LoadStats::get(const uint stage) const {
+    return m_stages[stage];
+}
+
+double LoadStats::getTotalTime() const {
+    double time = 0;
+
+    for (const Stage &stage : m_stages)
+        time += stage.time;
+
+    return time;
+}
+
+const char* LoadStats::getStageName(const uint stage) {
+    static const char *names[StagesCount] = {
+            "AMTLParse", "CacheLoad", "AssimpImport", "NodesAnimationsCopy", "ProcessNodes",
+            "MeshPostProcess", "CacheSave", "TexturesDecode", "BuffersPrepare",
+            "TexturesUpload", "BuffersUpload"
+    };
+
+    return stage < StagesCount ? names[stage] : "Unknown";
+}
+}
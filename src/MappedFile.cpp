@@ -0,0 +1,111 @@
+#include <algine/MappedFile.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace algine {
+MappedFile::MappedFile() = default;
+
+MappedFile::MappedFile(const std::string &path) {
+    open(path);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string &path) {
+    close();
+
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_file = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0) {
+        close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_mapping) {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const ubyte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    m_size = static_cast<usize>(fileSize.QuadPart);
+#else
+    m_fd = ::open(path.c_str(), O_RDONLY);
+    if (m_fd == -1)
+        return false;
+
+    struct stat fileStat {};
+    if (fstat(m_fd, &fileStat) == -1 || fileStat.st_size == 0) {
+        close();
+        return false;
+    }
+
+    void *data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+    if (data == MAP_FAILED) {
+        close();
+        return false;
+    }
+
+    m_data = static_cast<const ubyte*>(data);
+    m_size = static_cast<usize>(fileStat.st_size);
+#endif
+
+    if (!m_data) {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file)
+        CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if (m_data)
+        munmap(const_cast<ubyte*>(m_data), m_size);
+    if (m_fd != -1)
+        ::close(m_fd);
+    m_fd = -1;
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool MappedFile::isOpen() const {
+    return m_data != nullptr;
+}
+
+const ubyte* MappedFile::getData() const {
+    return m_data;
+}
+
+usize MappedFile::getSize() const {
+    return m_size;
+}
+}
@@ -0,0 +1,618 @@
+#define GLM_FORCE_CTOR_INIT
+#include <algine/MeshOptimizer.h>
+
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <unordered_map>
+#include <cmath>
+
+using namespace std;
+
+namespace algine {
+constexpr uint invalidIndex = ~0u;
+
+// FIFO cache simulation: vertex is in cache if less than `cacheSize` misses happened after its load
+inline uint simulateTriangle(const uint *triangle, vector<uint> &timestamps, uint &time, const uint cacheSize) {
+    uint misses = 0;
+
+    for (uint i = 0; i < 3; i++) {
+        uint &timestamp = timestamps[triangle[i]];
+
+        if (time - timestamp >= cacheSize) {
+            timestamp = time++;
+            misses++;
+        }
+    }
+
+    return misses;
+}
+
+// Tipsify: chooses next fanning vertex
+inline int64 getNextVertex(const vector<uint> &candidates, const vector<uint> &live,
+        const vector<uint> &timestamps, const uint time, const uint cacheSize,
+        vector<uint> &deadEnd, usize &cursor)
+{
+    int64 best = -1;
+    int64 bestPriority = -1;
+
+    for (const uint v : candidates) {
+        if (live[v] == 0)
+            continue;
+
+        // vertex will still be in cache after fanning all its triangles
+        int64 priority = 0;
+        if (time - timestamps[v] + 2 * live[v] <= cacheSize)
+            priority = time - timestamps[v];
+
+        if (priority > bestPriority) {
+            best = v;
+            bestPriority = priority;
+        }
+    }
+
+    if (best != -1)
+        return best;
+
+    // dead end: use the most recent vertex that still has triangles
+    while (!deadEnd.empty()) {
+        uint v = deadEnd.back();
+        deadEnd.pop_back();
+
+        if (live[v] != 0)
+            return v;
+    }
+
+    // take the next vertex in input order
+    for (; cursor < live.size(); cursor++)
+        if (live[cursor] != 0)
+            return cursor;
+
+    return -1;
+}
+
+void MeshOptimizer::optimizeVertexCache(uint *indices, const usize indicesCount, const usize verticesCount,
+        const uint cacheSize)
+{
+    usize trianglesCount = indicesCount / 3;
+
+    if (trianglesCount == 0)
+        return;
+
+    // vertex -> triangles adjacency
+    vector<uint> live(verticesCount, 0);
+    for (usize i = 0; i < indicesCount; i++)
+        live[indices[i]]++;
+
+    vector<uint> offsets(verticesCount + 1, 0);
+    for (usize v = 0; v < verticesCount; v++)
+        offsets[v + 1] = offsets[v] + live[v];
+
+    vector<uint> adjacency(indicesCount);
+    vector<uint> fill(offsets.begin(), offsets.end() - 1);
+    for (usize i = 0; i < indicesCount; i++)
+        adjacency[fill[indices[i]]++] = i / 3;
+
+    vector<uint> timestamps(verticesCount, 0);
+    vector<bool> emitted(trianglesCount, false);
+    vector<uint> deadEnd, candidates, result;
+    deadEnd.reserve(indicesCount);
+    result.reserve(indicesCount);
+
+    uint time = cacheSize + 1;
+    usize cursor = 0;
+    int64 fanning = indices[0];
+
+    while (fanning >= 0) {
+        candidates.clear();
+
+        for (uint k = offsets[fanning]; k < offsets[fanning + 1]; k++) {
+            uint triangle = adjacency[k];
+
+            if (emitted[triangle])
+                continue;
+
+            for (uint j = 0; j < 3; j++) {
+                uint v = indices[triangle * 3 + j];
+
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+
+                if (time - timestamps[v] > cacheSize)
+                    timestamps[v] = time++;
+            }
+
+            emitted[triangle] = true;
+        }
+
+        fanning = getNextVertex(candidates, live, timestamps, time, cacheSize, deadEnd, cursor);
+    }
+
+    copy(result.begin(), result.end(), indices);
+}
+
+struct Cluster {
+    usize start, end; // triangles
+    float sortKey;
+};
+
+inline void getTriangle(const uint *triangle, const float *positions, float centroid[3], float normal[3]) {
+    const float *a = positions + triangle[0] * 3;
+    const float *b = positions + triangle[1] * 3;
+    const float *c = positions + triangle[2] * 3;
+
+    float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+
+    // not normalized: length is proportional to triangle area
+    normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+    normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+    normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+
+    for (uint i = 0; i < 3; i++)
+        centroid[i] = (a[i] + b[i] + c[i]) / 3.0f;
+}
+
+void MeshOptimizer::optimizeOverdraw(uint *indices, const usize indicesCount, const float *positions,
+        const usize verticesCount, const uint cacheSize, const float threshold)
+{
+    usize trianglesCount = indicesCount / 3;
+
+    if (trianglesCount == 0)
+        return;
+
+    float meshACMR = getACMR(indices, indicesCount, verticesCount, cacheSize);
+
+    // split to clusters: hard boundaries are the cache restarts,
+    // soft boundaries are placed when cluster ACMR fits the threshold
+    vector<usize> starts = {0};
+    vector<uint> timestamps(verticesCount, 0);
+    uint time = cacheSize;
+    uint clusterMisses = 0;
+
+    for (usize t = 0; t < trianglesCount; t++) {
+        uint misses = simulateTriangle(indices + t * 3, timestamps, time, cacheSize);
+
+        if (t != starts.back() && misses == 3) {
+            starts.push_back(t);
+            clusterMisses = 0;
+        }
+
+        clusterMisses += misses;
+
+        if (t + 1 < trianglesCount && clusterMisses <= threshold * meshACMR * (t - starts.back() + 1)) {
+            starts.push_back(t + 1);
+            clusterMisses = 0;
+            time += cacheSize; // flush cache
+        }
+    }
+
+    vector<Cluster> clusters(starts.size());
+    vector<float> centroids(starts.size() * 3, 0.0f), normals(starts.size() * 3, 0.0f);
+    float meshCentroid[3] = {0.0f, 0.0f, 0.0f}, meshArea = 0.0f;
+
+    for (usize i = 0; i < clusters.size(); i++) {
+        Cluster &cluster = clusters[i];
+        cluster.start = starts[i];
+        cluster.end = i + 1 < starts.size() ? starts[i + 1] : trianglesCount;
+
+        float *clusterCentroid = &centroids[i * 3];
+        float *clusterNormal = &normals[i * 3];
+        float clusterArea = 0.0f;
+
+        for (usize t = cluster.start; t < cluster.end; t++) {
+            float centroid[3], normal[3];
+            getTriangle(indices + t * 3, positions, centroid, normal);
+
+            float area = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+            for (uint j = 0; j < 3; j++) {
+                clusterCentroid[j] += centroid[j] * area;
+                clusterNormal[j] += normal[j];
+                meshCentroid[j] += centroid[j] * area;
+            }
+
+            clusterArea += area;
+        }
+
+        if (clusterArea > 0.0f)
+            for (uint j = 0; j < 3; j++)
+                clusterCentroid[j] /= clusterArea;
+
+        meshArea += clusterArea;
+    }
+
+    if (meshArea > 0.0f)
+        for (float &c : meshCentroid)
+            c /= meshArea;
+
+    // clusters that face away from the mesh center are likely to occlude others
+    for (usize i = 0; i < clusters.size(); i++) {
+        const float *c = &centroids[i * 3];
+        const float *n = &normals[i * 3];
+        float length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        clusters[i].sortKey = 0.0f;
+
+        if (length > 0.0f) {
+            for (uint j = 0; j < 3; j++) {
+                clusters[i].sortKey += (c[j] - meshCentroid[j]) * n[j] / length;
+            }
+        }
+    }
+
+    stable_sort(clusters.begin(), clusters.end(), [](const Cluster &a, const Cluster &b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    vector<uint> result;
+    result.reserve(trianglesCount * 3);
+
+    for (const Cluster &cluster : clusters)
+        result.insert(result.end(), indices + cluster.start * 3, indices + cluster.end * 3);
+
+    copy(result.begin(), result.end(), indices);
+}
+
+vector<uint> MeshOptimizer::optimizeVertexFetch(uint *indices, const usize indicesCount, const usize verticesCount) {
+    vector<uint> remap(verticesCount, invalidIndex);
+    uint next = 0;
+
+    for (usize i = 0; i < indicesCount; i++) {
+        uint &newIndex = remap[indices[i]];
+
+        if (newIndex == invalidIndex)
+            newIndex = next++;
+
+        indices[i] = newIndex;
+    }
+
+    // unreferenced vertices are moved to the end
+    for (uint &newIndex : remap)
+        if (newIndex == invalidIndex)
+            newIndex = next++;
+
+    return remap;
+}
+
+// symmetric 4x4 matrix: weighted sum of squared distances to the planes
+struct Quadric {
+    double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+    double weight = 0; // sum of the plane weights
+
+    void addPlane(const double a, const double b, const double c, const double d, const double w) {
+        a2 += a * a * w; ab += a * b * w; ac += a * c * w; ad += a * d * w;
+        b2 += b * b * w; bc += b * c * w; bd += b * d * w;
+        c2 += c * c * w; cd += c * d * w;
+        d2 += d * d * w;
+        weight += w;
+    }
+
+    void add(const Quadric &q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+        weight += q.weight;
+    }
+
+    /**
+     * @return weighted mean of the squared distances, so it is a squared
+     * distance in model space, independent of the triangles area
+     */
+    double error(const float *p) const {
+        return weight > 0 ? weightedError(p) / weight : 0;
+    }
+
+    double weightedError(const float *p) const {
+        double x = p[0], y = p[1], z = p[2];
+        double result = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+                        b2 * y * y + 2 * bc * y * z + 2 * bd * y +
+                        c2 * z * z + 2 * cd * z +
+                        d2;
+        return result > 0 ? result : 0;
+    }
+};
+
+struct Collapse {
+    uint from, to;
+    double error;
+};
+
+inline void getNormal(const float *a, const float *b, const float *c, double normal[3]) {
+    double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    double ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+
+    normal[0] = ab[1] * ac[2] - ab[2] * ac[1];
+    normal[1] = ab[2] * ac[0] - ab[0] * ac[2];
+    normal[2] = ab[0] * ac[1] - ab[1] * ac[0];
+}
+
+inline uint64 getEdgeKey(uint a, uint b) {
+    if (a > b)
+        swap(a, b);
+
+    return (static_cast<uint64>(a) << 32u) | b;
+}
+
+vector<uint> MeshOptimizer::simplify(const uint *indices, const usize indicesCount, const float *positions,
+        const usize verticesCount, const usize targetIndicesCount, const float maxError, float *resultError)
+{
+    vector<uint> result(indices, indices + indicesCount);
+    double maxErrorSq = static_cast<double>(maxError) * maxError;
+    double achievedErrorSq = 0;
+
+    // vertex quadrics: planes of the adjacent triangles weighted by area
+    vector<Quadric> quadrics(verticesCount);
+
+    for (usize i = 0; i < indicesCount; i += 3) {
+        const float *p0 = positions + indices[i] * 3;
+        double n[3];
+        getNormal(p0, positions + indices[i + 1] * 3, positions + indices[i + 2] * 3, n);
+
+        double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+        if (length == 0)
+            continue;
+
+        double a = n[0] / length, b = n[1] / length, c = n[2] / length;
+        double d = -(a * p0[0] + b * p0[1] + c * p0[2]);
+
+        for (uint j = 0; j < 3; j++) {
+            quadrics[indices[i + j]].addPlane(a, b, c, d, length * 0.5);
+        }
+    }
+
+    // edges used by one triangle are borders or seams (after vertex joining
+    // seams are split), more than two triangles - non-manifold
+    vector<bool> locked(verticesCount, false);
+
+    {
+        unordered_map<uint64, uint> edges;
+
+        for (usize i = 0; i < indicesCount; i += 3)
+            for (uint j = 0; j < 3; j++)
+                edges[getEdgeKey(indices[i + j], indices[i + (j + 1) % 3])]++;
+
+        for (const auto &edge : edges) {
+            if (edge.second != 2) {
+                locked[edge.first >> 32u] = true;
+                locked[edge.first & 0xffffffffu] = true;
+            }
+        }
+    }
+
+    vector<uint> offsets(verticesCount + 1), adjacency, remap(verticesCount);
+    vector<bool> touched(verticesCount);
+    vector<Collapse> collapses;
+
+    while (result.size() > targetIndicesCount) {
+        // vertex -> triangles adjacency of the current result
+        fill(offsets.begin(), offsets.end(), 0);
+        for (const uint v : result)
+            offsets[v + 1]++;
+        for (usize v = 0; v < verticesCount; v++)
+            offsets[v + 1] += offsets[v];
+
+        adjacency.resize(result.size());
+        vector<uint> cursor(offsets.begin(), offsets.end() - 1);
+        for (usize i = 0; i < result.size(); i++)
+            adjacency[cursor[result[i]]++] = i / 3;
+
+        // collapse candidates
+        collapses.clear();
+
+        for (usize i = 0; i < result.size(); i += 3) {
+            for (uint j = 0; j < 3; j++) {
+                uint a = result[i + j], b = result[i + (j + 1) % 3];
+
+                Quadric q = quadrics[a];
+                q.add(quadrics[b]);
+
+                if (!locked[a])
+                    collapses.push_back({a, b, q.error(positions + b * 3)});
+
+                if (!locked[b])
+                    collapses.push_back({b, a, q.error(positions + a * 3)});
+            }
+        }
+
+        sort(collapses.begin(), collapses.end(), [](const Collapse &c1, const Collapse &c2) {
+            return c1.error < c2.error;
+        });
+
+        for (usize v = 0; v < verticesCount; v++)
+            remap[v] = v;
+
+        fill(touched.begin(), touched.end(), false);
+
+        // each collapse removes about 2 triangles
+        usize collapsesNeeded = (result.size() - targetIndicesCount) / 6 + 1;
+        usize collapsesDone = 0;
+
+        for (const Collapse &collapse : collapses) {
+            if (collapse.error > maxErrorSq || collapsesDone >= collapsesNeeded)
+                break;
+
+            uint from = collapse.from, to = collapse.to;
+
+            if (touched[from] || touched[to])
+                continue;
+
+            // collapse must not flip the triangles
+            bool flips = false;
+
+            for (uint k = offsets[from]; k < offsets[from + 1] && !flips; k++) {
+                const uint *triangle = &result[adjacency[k] * 3];
+
+                if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+                    continue;
+
+                const float *p[3], *moved[3];
+                for (uint j = 0; j < 3; j++) {
+                    p[j] = positions + triangle[j] * 3;
+                    moved[j] = triangle[j] == from ? positions + to * 3 : p[j];
+                }
+
+                double before[3], after[3];
+                getNormal(p[0], p[1], p[2], before);
+                getNormal(moved[0], moved[1], moved[2], after);
+
+                flips = before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0;
+            }
+
+            if (flips)
+                continue;
+
+            // neighbourhood of `from` changes, so it must stay untouched during this pass
+            for (uint k = offsets[from]; k < offsets[from + 1]; k++)
+                for (uint j = 0; j < 3; j++)
+                    touched[result[adjacency[k] * 3 + j]] = true;
+
+            remap[from] = to;
+            quadrics[to].add(quadrics[from]);
+            achievedErrorSq = max(achievedErrorSq, collapse.error);
+            collapsesDone++;
+        }
+
+        if (collapsesDone == 0)
+            break;
+
+        // apply collapses & remove degenerate triangles
+        usize size = 0;
+
+        for (usize i = 0; i < result.size(); i += 3) {
+            uint a = remap[result[i]], b = remap[result[i + 1]], c = remap[result[i + 2]];
+
+            if (a != b && b != c && a != c) {
+                result[size++] = a;
+                result[size++] = b;
+                result[size++] = c;
+            }
+        }
+
+        result.resize(size);
+    }
+
+    if (resultError != nullptr)
+        *resultError = static_cast<float>(sqrt(achievedErrorSq));
+
+    return result;
+}
+
+inline glm::vec3 getPosition(const float *positions, const uint index) {
+    return glm::vec3(positions[index * 3], positions[index * 3 + 1], positions[index * 3 + 2]);
+}
+
+inline void computeMeshletBounds(Meshlet &meshlet, const uint *indices, const float *positions) {
+    // bounding sphere: box center & max distance
+    glm::vec3 min = getPosition(positions, indices[meshlet.start]), max = min;
+
+    for (uint i = meshlet.start; i < meshlet.start + meshlet.count; i++) {
+        glm::vec3 p = getPosition(positions, indices[i]);
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    meshlet.center = (min + max) * 0.5f;
+    meshlet.radius = 0;
+
+    for (uint i = meshlet.start; i < meshlet.start + meshlet.count; i++)
+        meshlet.radius = std::max(meshlet.radius, glm::length(getPosition(positions, indices[i]) - meshlet.center));
+
+    // normal cone
+    glm::vec3 axis(0.0f);
+    vector<glm::vec3> normals;
+    normals.reserve(meshlet.count / 3);
+
+    for (uint i = meshlet.start; i < meshlet.start + meshlet.count; i += 3) {
+        glm::vec3 a = getPosition(positions, indices[i]);
+        glm::vec3 normal = glm::cross(getPosition(positions, indices[i + 1]) - a, getPosition(positions, indices[i + 2]) - a);
+        float length = glm::length(normal);
+
+        if (length > 0) {
+            normals.push_back(normal / length);
+            axis += normals.back();
+        }
+    }
+
+    meshlet.coneAxis = glm::vec3(0.0f);
+    meshlet.coneCutoff = 1;
+
+    float axisLength = glm::length(axis);
+
+    if (axisLength == 0)
+        return;
+
+    axis /= axisLength;
+
+    float minDot = 1;
+    for (const glm::vec3 &normal : normals)
+        minDot = std::min(minDot, glm::dot(normal, axis));
+
+    // wide cones are almost never culled
+    if (minDot <= 0.1f)
+        return;
+
+    meshlet.coneAxis = axis;
+    meshlet.coneCutoff = sqrt(1 - minDot * minDot);
+}
+
+vector<Meshlet> MeshOptimizer::buildMeshlets(const uint *indices, const usize indicesCount, const float *positions,
+        const uint maxVertices, const uint maxTriangles)
+{
+    vector<Meshlet> meshlets;
+    vector<uint> vertices; // unique vertices of the current meshlet
+    vertices.reserve(maxVertices);
+
+    Meshlet meshlet;
+
+    for (usize i = 0; i + 2 < indicesCount; i += 3) {
+        uint newVertices = 0;
+
+        for (uint j = 0; j < 3; j++)
+            if (find(vertices.begin(), vertices.end(), indices[i + j]) == vertices.end())
+                newVertices++;
+
+        if (vertices.size() + newVertices > maxVertices || meshlet.count / 3 + 1 > maxTriangles) {
+            meshlets.push_back(meshlet);
+            meshlet = Meshlet();
+            meshlet.start = i;
+            vertices.clear();
+        }
+
+        for (uint j = 0; j < 3; j++)
+            if (find(vertices.begin(), vertices.end(), indices[i + j]) == vertices.end())
+                vertices.push_back(indices[i + j]);
+
+        meshlet.count += 3;
+    }
+
+    if (meshlet.count != 0)
+        meshlets.push_back(meshlet);
+
+    for (Meshlet &m : meshlets)
+        computeMeshletBounds(m, indices, positions);
+
+    return meshlets;
+}
+
+float MeshOptimizer::getACMR(const uint *indices, const usize indicesCount, const usize verticesCount,
+        const uint cacheSize)
+{
+    usize trianglesCount = indicesCount / 3;
+
+    if (trianglesCount == 0)
+        return 0.0f;
+
+    vector<uint> timestamps(verticesCount, 0);
+    uint time = cacheSize;
+    usize misses = 0;
+
+    for (usize t = 0; t < trianglesCount; t++)
+        misses += simulateTriangle(indices + t * 3, timestamps, time, cacheSize);
+
+    return static_cast<float>(misses) / trianglesCount;
+}
+}
@@ -0,0 +1,34 @@
+#define GLM_FORCE_CTOR_INIT
+#include <algine/Meshlet.h>
+
+#include <glm/glm.hpp>
+
+namespace algine {
+bool Meshlet::isInFrustum(const glm::vec4 *planes) const {
+    for (uint i = 0; i < 6; i++)
+        if (glm::dot(glm::vec3(planes[i]), center) + planes[i].w < -radius)
+            return false;
+
+    return true;
+}
+
+bool Meshlet::isBackFacing(const glm::vec3 &cameraPos) const {
+    glm::vec3 view = center - cameraPos;
+    return glm::dot(view, coneAxis) >= coneCutoff * glm::length(view) + radius;
+}
+
+void Meshlet::getFrustumPlanes(const glm::mat4 &matrix, glm::vec4 *planes) {
+    glm::vec4 rows[4];
+    for (uint i = 0; i < 4; i++)
+        rows[i] = glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]);
+
+    // left, right, bottom, top, near, far
+    for (uint i = 0; i < 3; i++) {
+        planes[i * 2] = rows[3] + rows[i];
+        planes[i * 2 + 1] = rows[3] - rows[i];
+    }
+
+    for (uint i = 0; i < 6; i++)
+        planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+}
+}
@@ -0,0 +1,206 @@
+#include <algine/MipmapGenerator.h>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace algine {
+constexpr uint kaiserTaps = 6;
+
+// modified Bessel function of the first kind, order 0
+inline float bessel0(const float x) {
+    float sum = 1.0f, term = 1.0f;
+
+    for (uint k = 1; k < 16; k++) {
+        term *= (x / (2.0f * k)) * (x / (2.0f * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+// weights for the taps at -2.5, -1.5, ..., 2.5 source pixels from the destination pixel center
+inline const float* getKaiserWeights() {
+    static const float *weights = []() {
+        static float result[kaiserTaps];
+        const float beta = 4.0f, radius = 3.0f;
+        float sum = 0;
+
+        for (uint i = 0; i < kaiserTaps; i++) {
+            float d = static_cast<float>(i) - 2.5f;
+            float x = static_cast<float>(M_PI) * d / 2.0f;
+            float sinc = std::sin(x) / x;
+            float window = bessel0(beta * std::sqrt(1.0f - (d / radius) * (d / radius))) / bessel0(beta);
+
+            result[i] = sinc * window;
+            sum += result[i];
+        }
+
+        for (float &weight : result)
+            weight /= sum;
+
+        return result;
+    }();
+
+    return weights;
+}
+
+inline float srgbToLinear(const float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+inline float linearToSrgb(const float value) {
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+// color channels of gray + alpha and RGBA images don't include alpha
+inline uint getColorChannels(const uint channels) {
+    return channels == 2 || channels == 4 ? channels - 1 : channels;
+}
+
+/**
+ * Downsamples image 2 times along one axis
+ * @param step distance between neighbour pixels along the axis, in pixels
+ * @param lines count of the lines along the axis
+ * @param srcLineStep, dstLineStep distance between lines in src and dst, in pixels
+ */
+inline void downsampleAxis(const vector<float> &src, vector<float> &dst, const uint channels,
+        const uint size, const uint step, const uint lines, const uint srcLineStep, const uint dstLineStep,
+        const uint filter)
+{
+    uint newSize = std::max(size / 2, 1u);
+    const float *weights = getKaiserWeights();
+
+    for (uint line = 0; line < lines; line++) {
+        for (uint i = 0; i < newSize; i++) {
+            for (uint c = 0; c < channels; c++) {
+                float value = 0;
+
+                if (filter == MipmapGenerator::Box) {
+                    uint i0 = std::min(i * 2, size - 1), i1 = std::min(i * 2 + 1, size - 1);
+                    value = 0.5f * (src[(line * srcLineStep + i0 * step) * channels + c] +
+                                    src[(line * srcLineStep + i1 * step) * channels + c]);
+                } else {
+                    // edge pixels are clamped
+                    for (uint tap = 0; tap < kaiserTaps; tap++) {
+                        int position = static_cast<int>(i * 2 + tap) - 2;
+                        auto clamped = static_cast<uint>(std::min(std::max(position, 0), static_cast<int>(size) - 1));
+                        value += weights[tap] * src[(line * srcLineStep + clamped * step) * channels + c];
+                    }
+                }
+
+                dst[(line * dstLineStep + i * step) * channels + c] = value;
+            }
+        }
+    }
+}
+
+inline vector<float> downsample(const vector<float> &src, const uint width, const uint height,
+        const uint channels, const uint filter)
+{
+    uint newWidth = std::max(width / 2, 1u), newHeight = std::max(height / 2, 1u);
+    vector<float> horizontal(static_cast<usize>(newWidth) * height * channels);
+    vector<float> result(static_cast<usize>(newWidth) * newHeight * channels);
+
+    // rows: pixels are neighbours
+    if (width > 1)
+        downsampleAxis(src, horizontal, channels, width, 1, height, width, newWidth, filter);
+    else
+        horizontal = src;
+
+    // columns: pixels are `newWidth` apart, columns are neighbours
+    if (height > 1)
+        downsampleAxis(horizontal, result, channels, height, newWidth, newWidth, 1, 1, filter);
+    else
+        result = horizontal;
+
+    return result;
+}
+
+vector<MipmapGenerator::Level> MipmapGenerator::generate(const ubyte *data, const uint width, const uint height,
+        const uint channels, const uint filter, const uint flags)
+{
+    vector<Level> levels;
+
+    if (data == nullptr || channels == 0 || (width <= 1 && height <= 1))
+        return levels;
+
+    bool gammaCorrect = flags & GammaCorrect;
+    bool normalMap = (flags & NormalMap) && channels >= 3;
+    uint colorChannels = getColorChannels(channels);
+
+    // to linear float
+    float toLinear[256];
+
+    for (uint i = 0; i < 256; i++)
+        toLinear[i] = gammaCorrect ? srgbToLinear(i / 255.0f) : i / 255.0f;
+
+    usize pixelsCount = static_cast<usize>(width) * height;
+    vector<float> pixels(pixelsCount * channels);
+
+    for (usize i = 0; i < pixelsCount; i++) {
+        for (uint c = 0; c < channels; c++) {
+            ubyte value = data[i * channels + c];
+
+            if (normalMap && c < 3)
+                pixels[i * channels + c] = value / 255.0f * 2.0f - 1.0f;
+            else
+                pixels[i * channels + c] = c < colorChannels ? toLinear[value] : value / 255.0f;
+        }
+    }
+
+    uint levelWidth = width, levelHeight = height;
+    levels.reserve(getLevelsCount(width, height) - 1);
+
+    while (levelWidth > 1 || levelHeight > 1) {
+        pixels = downsample(pixels, levelWidth, levelHeight, channels, filter);
+        levelWidth = std::max(levelWidth / 2, 1u);
+        levelHeight = std::max(levelHeight / 2, 1u);
+
+        levels.push_back({levelWidth, levelHeight, {}});
+        vector<ubyte> &levelData = levels.back().data;
+
+        pixelsCount = static_cast<usize>(levelWidth) * levelHeight;
+        levelData.resize(pixelsCount * channels);
+
+        for (usize i = 0; i < pixelsCount; i++) {
+            float *pixel = &pixels[i * channels];
+
+            if (normalMap) {
+                float length = std::sqrt(pixel[0] * pixel[0] + pixel[1] * pixel[1] + pixel[2] * pixel[2]);
+
+                if (length > 0)
+                    for (uint c = 0; c < 3; c++)
+                        pixel[c] /= length;
+            }
+
+            for (uint c = 0; c < channels; c++) {
+                float value = pixel[c];
+
+                if (normalMap && c < 3)
+                    value = value * 0.5f + 0.5f;
+                else if (gammaCorrect && c < colorChannels)
+                    value = linearToSrgb(std::max(value, 0.0f));
+
+                value = std::min(std::max(value, 0.0f), 1.0f);
+                levelData[i * channels + c] = static_cast<ubyte>(value * 255.0f + 0.5f);
+            }
+        }
+    }
+
+    return levels;
+}
+
+uint MipmapGenerator::getLevelsCount(uint width, uint height) {
+    uint count = 1;
+
+    while (width > 1 || height > 1) {
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        count++;
+    }
+
+    return count;
+}
+}
@@ -0,0 +1,91 @@
+#include <algine/PackIOSystem.h>
+
+#include <cstring>
+#include <algorithm>
+
+namespace algine {
+PackIOSystem::PackIOSystem(const AssetPack *pack): m_pack(pack) {
+    /* empty */
+}
+
+bool PackIOSystem::Exists(const char *file) const {
+    return m_pack->exists(file);
+}
+
+char PackIOSystem::getOsSeparator() const {
+    return '/';
+}
+
+Assimp::IOStream* PackIOSystem::Open(const char *file, const char *mode) {
+    // pack is read-only
+    if (strchr(mode, 'w') != nullptr || strchr(mode, 'a') != nullptr)
+        return nullptr;
+
+    auto stream = new PackIOStream();
+
+    if (!m_pack->read(file, stream->m_data, stream->m_size, stream->m_buffer)) {
+        delete stream;
+        return nullptr;
+    }
+
+    return stream;
+}
+
+void PackIOSystem::Close(Assimp::IOStream *file) {
+    delete file;
+}
+
+size_t PackIOStream::Read(void *buffer, const size_t size, const size_t count) {
+    if (size == 0)
+        return 0;
+
+    size_t readCount = std::min(count, (m_size - m_pos) / size);
+    memcpy(buffer, m_data + m_pos, readCount * size);
+    m_pos += readCount * size;
+
+    return readCount;
+}
+
+size_t PackIOStream::Write(const void * /*buffer*/, size_t /*size*/, size_t /*count*/) {
+    return 0;
+}
+
+aiReturn PackIOStream::Seek(const size_t offset, const aiOrigin origin) {
+    usize pos;
+
+    switch (origin) {
+        case aiOrigin_SET:
+            pos = offset;
+            break;
+        case aiOrigin_CUR:
+            pos = m_pos + offset;
+            break;
+        case aiOrigin_END:
+            if (offset > m_size)
+                return aiReturn_FAILURE;
+            pos = m_size - offset;
+            break;
+        default:
+            return aiReturn_FAILURE;
+    }
+
+    if (pos > m_size)
+        return aiReturn_FAILURE;
+
+    m_pos = pos;
+
+    return aiReturn_SUCCESS;
+}
+
+size_t PackIOStream::Tell() const {
+    return m_pos;
+}
+
+size_t PackIOStream::FileSize() const {
+    return m_size;
+}
+
+void PackIOStream::Flush() {
+    /* empty */
+}
+}
@@ -0,0 +1,456 @@
+#define GLM_FORCE_CTOR_INIT
+#include <algine/ShapeCache.h>
+
+#include <algine/model.h>
+#include <algine/MappedFile.h>
+#include <algine/AssetPack.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+namespace algine {
+constexpr uint cacheMagic = 0x43485341; // "ASHC"
+constexpr uint cacheAlignment = 16;
+
+constexpr uint ShapeCache::Version;
+
+struct FileInfo {
+    int64 mtime = -1;
+    uint64 size = 0;
+
+    FileInfo() = default;
+
+    explicit FileInfo(const string &path) {
+        struct stat fileStat {};
+        if (stat(path.c_str(), &fileStat) == 0) {
+            mtime = static_cast<int64>(fileStat.st_mtime);
+            size = static_cast<uint64>(fileStat.st_size);
+        }
+    }
+};
+
+class CacheWriter {
+public:
+    explicit CacheWriter(ofstream &out): m_out(out) { /* empty */ }
+
+    template<typename T>
+    void write(const T &value) {
+        m_out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(const string &str) {
+        write<uint>(str.size());
+        m_out.write(str.data(), str.size());
+    }
+
+    // arrays are aligned, so after mapping they can be used directly
+    template<typename T>
+    void writeArray(const vector<T> &array) {
+        write<uint64>(array.size());
+        align();
+        m_out.write(reinterpret_cast<const char*>(array.data()), array.size() * sizeof(T));
+    }
+
+    void align() {
+        static const char zeros[cacheAlignment] {};
+        auto pos = static_cast<uint64>(m_out.tellp());
+        m_out.write(zeros, (cacheAlignment - pos % cacheAlignment) % cacheAlignment);
+    }
+
+protected:
+    ofstream &m_out;
+};
+
+class CacheReader {
+public:
+    CacheReader(const ubyte *data, usize size): m_begin(data), m_pos(data), m_end(data + size) { /* empty */ }
+
+    template<typename T>
+    bool read(T &value) {
+        if (m_pos + sizeof(T) > m_end)
+            return m_ok = false;
+
+        memcpy(&value, m_pos, sizeof(T));
+        m_pos += sizeof(T);
+
+        return true;
+    }
+
+    bool read(string &str) {
+        uint length = 0;
+        if (!read(length) || m_pos + length > m_end)
+            return m_ok = false;
+
+        str.assign(reinterpret_cast<const char*>(m_pos), length);
+        m_pos += length;
+
+        return true;
+    }
+
+    /**
+     * Reads elements count and checks that `count` elements of at least
+     * `elementSize` bytes each fit into the rest of the data, so corrupted
+     * counts are rejected before allocation
+     */
+    bool readCount(uint &count, const usize elementSize) {
+        if (!read(count) || count > static_cast<usize>(m_end - m_pos) / elementSize)
+            return m_ok = false;
+
+        return true;
+    }
+
+    template<typename T>
+    bool readArray(vector<T> &array) {
+        uint64 count = 0;
+        if (!read(count) || !align() || count > static_cast<uint64>(m_end - m_pos) / sizeof(T))
+            return m_ok = false;
+
+        array.resize(count);
+        memcpy(array.data(), m_pos, count * sizeof(T));
+        m_pos += count * sizeof(T);
+
+        return true;
+    }
+
+    bool align() {
+        auto pos = static_cast<usize>(m_pos - m_begin);
+        m_pos += (cacheAlignment - pos % cacheAlignment) % cacheAlignment;
+        return m_pos <= m_end || (m_ok = false);
+    }
+
+    bool isOk() const {
+        return m_ok;
+    }
+
+protected:
+    const ubyte *m_begin, *m_pos, *m_end;
+    bool m_ok = true;
+};
+
+inline string getAMTLPath(const string &modelPath) {
+    return modelPath.substr(0, modelPath.find_last_of('.')) + ".amtl";
+}
+
+// if the loader reads from the pack, the pack file is the source of all assets
+inline FileInfo getSourceInfo(const ShapeLoader &loader, const string &path) {
+    const AssetPack *pack = loader.m_assetPack;
+
+    if (pack != nullptr)
+        return pack->exists(path) ? FileInfo(pack->getPath()) : FileInfo();
+
+    return FileInfo(path);
+}
+
+// key: magic, version, model path, model & AMTL file info, params, bones per vertex
+inline void writeKey(CacheWriter &writer, const ShapeLoader &loader) {
+    FileInfo model = getSourceInfo(loader, loader.m_modelPath);
+    FileInfo amtl = getSourceInfo(loader, getAMTLPath(loader.m_modelPath));
+
+    writer.write(cacheMagic);
+    writer.write(ShapeCache::Version);
+    writer.write(loader.m_modelPath);
+    writer.write(model.mtime);
+    writer.write(model.size);
+    writer.write(amtl.mtime);
+    writer.write(amtl.size);
+    writer.writeArray(loader.m_params);
+    writer.write(loader.m_shape->bonesPerVertex);
+}
+
+inline bool checkKey(CacheReader &reader, const ShapeLoader &loader) {
+    FileInfo model = getSourceInfo(loader, loader.m_modelPath);
+    FileInfo amtl = getSourceInfo(loader, getAMTLPath(loader.m_modelPath));
+
+    uint magic = 0, version = 0, bonesPerVertex = 0;
+    string modelPath;
+    FileInfo cachedModel, cachedAmtl;
+    vector<uint> params;
+
+    return reader.read(magic) && magic == cacheMagic &&
+        reader.read(version) && version == ShapeCache::Version &&
+        reader.read(modelPath) && modelPath == loader.m_modelPath &&
+        reader.read(cachedModel.mtime) && cachedModel.mtime == model.mtime &&
+        reader.read(cachedModel.size) && cachedModel.size == model.size &&
+        reader.read(cachedAmtl.mtime) && cachedAmtl.mtime == amtl.mtime &&
+        reader.read(cachedAmtl.size) && cachedAmtl.size == amtl.size &&
+        reader.readArray(params) && params == loader.m_params &&
+        reader.read(bonesPerVertex) && bonesPerVertex == loader.m_shape->bonesPerVertex;
+}
+
+inline void writeNode(CacheWriter &writer, const Node &node) {
+    writer.write(node.name);
+    writer.write(node.defaultTransform);
+    writer.write<uint>(node.childs.size());
+
+    for (const Node &child : node.childs)
+        writeNode(writer, child);
+}
+
+inline bool readNode(CacheReader &reader, Node &node) {
+    uint childsCount = 0;
+
+    // child takes at least name length, default transform and childs count
+    constexpr usize minNodeSize = sizeof(uint) + sizeof(glm::mat4) + sizeof(uint);
+
+    if (!reader.read(node.name) || !reader.read(node.defaultTransform) || !reader.readCount(childsCount, minNodeSize))
+        return false;
+
+    node.childs.resize(childsCount);
+    for (Node &child : node.childs)
+        if (!readNode(reader, child))
+            return false;
+
+    return true;
+}
+
+template<typename T>
+inline void writeKeys(CacheWriter &writer, const vector<T> &keys) {
+    writer.write<uint>(keys.size());
+    for (const T &key : keys) {
+        writer.write(key.time);
+        writer.write(key.value);
+    }
+}
+
+template<typename T>
+inline bool readKeys(CacheReader &reader, vector<T> &keys) {
+    uint count = 0;
+    if (!reader.readCount(count, sizeof(T::time) + sizeof(T::value)))
+        return false;
+
+    keys.resize(count);
+    for (T &key : keys)
+        if (!reader.read(key.time) || !reader.read(key.value))
+            return false;
+
+    return true;
+}
+
+bool ShapeCache::save(const std::string &path, const ShapeLoader &loader) {
+    // write to temporary file first, so the broken cache will never be read
+    string tmpPath = path + ".tmp";
+    ofstream out(tmpPath, ios::binary | ios::trunc);
+
+    if (!out.is_open()) {
+        cerr << "ShapeCache: can't open " << tmpPath << " for writing\n";
+        return false;
+    }
+
+    const Shape *shape = loader.m_shape;
+    CacheWriter writer(out);
+    writeKey(writer, loader);
+
+    writer.write(shape->globalInverseTransform);
+
+    // geometry
+    writer.writeArray(shape->geometry.vertices);
+    writer.writeArray(shape->geometry.normals);
+    writer.writeArray(shape->geometry.texCoords);
+    writer.writeArray(shape->geometry.tangents);
+    writer.writeArray(shape->geometry.bitangents);
+    writer.writeArray(shape->geometry.boneWeights);
+    writer.writeArray(shape->geometry.indices);
+    writer.writeArray(shape->geometry.boneIds);
+
+    // meshes & materials
+    writer.write<uint>(shape->meshes.size());
+    for (usize i = 0; i < shape->meshes.size(); i++) {
+        const Mesh &mesh = shape->meshes[i];
+        const ShapeLoader::MaterialTexPaths &texPaths = loader.m_materialTexPaths[i];
+
+        writer.write(mesh.start);
+        writer.write(mesh.count);
+        writer.write(mesh.material.name);
+        writer.write(mesh.material.ambientStrength);
+        writer.write(mesh.material.diffuseStrength);
+        writer.write(mesh.material.specularStrength);
+        writer.write(mesh.material.shininess);
+        writer.write(mesh.material.reflection);
+        writer.write(mesh.material.jitter);
+        writer.write(texPaths.ambient);
+        writer.write(texPaths.diffuse);
+        writer.write(texPaths.specular);
+        writer.write(texPaths.normal);
+        writer.write(texPaths.reflection);
+        writer.write(texPaths.jitter);
+        writer.writeArray(mesh.lods);
+        writer.write(mesh.meshletsStart);
+        writer.write(mesh.meshletsCount);
+    }
+
+    writer.writeArray(shape->lodErrors);
+    writer.writeArray(shape->meshlets);
+
+    // bones
+    writer.write<uint>(shape->bones.size());
+    for (const Bone &bone : shape->bones) {
+        writer.write(bone.name);
+        writer.write(bone.offsetMatrix);
+    }
+
+    // node tree
+    writeNode(writer, shape->rootNode);
+
+    // animations
+    writer.write<uint>(shape->animations.size());
+    for (const Animation &animation : shape->animations) {
+        writer.write(animation.name);
+        writer.write(animation.ticksPerSecond);
+        writer.write(animation.duration);
+        writer.write<uint>(animation.channels.size());
+
+        for (const AnimNode &channel : animation.channels) {
+            writer.write(channel.name);
+            writeKeys(writer, channel.scalingKeys);
+            writeKeys(writer, channel.positionKeys);
+            writeKeys(writer, channel.rotationKeys);
+        }
+    }
+
+    writer.write(cacheMagic); // end marker
+    out.close();
+
+    if (out.fail()) {
+        cerr << "ShapeCache: can't write " << tmpPath << "\n";
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    remove(path.c_str()); // rename fails on Windows if the destination exists
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        cerr << "ShapeCache: can't rename " << tmpPath << " to " << path << "\n";
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool ShapeCache::load(const std::string &path, ShapeLoader &loader) {
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+
+    CacheReader reader(file.getData(), file.getSize());
+    if (!checkKey(reader, loader))
+        return false;
+
+    // reading to the temporary shape, so on failure loader's shape stays untouched
+    Shape shape;
+    vector<ShapeLoader::MaterialTexPaths> materialTexPaths;
+
+    reader.read(shape.globalInverseTransform);
+
+    // geometry
+    reader.readArray(shape.geometry.vertices);
+    reader.readArray(shape.geometry.normals);
+    reader.readArray(shape.geometry.texCoords);
+    reader.readArray(shape.geometry.tangents);
+    reader.readArray(shape.geometry.bitangents);
+    reader.readArray(shape.geometry.boneWeights);
+    reader.readArray(shape.geometry.indices);
+    reader.readArray(shape.geometry.boneIds);
+
+    // meshes & materials
+    uint meshesCount = 0;
+    reader.read(meshesCount);
+
+    for (uint i = 0; i < meshesCount && reader.isOk(); i++) {
+        Mesh mesh;
+        ShapeLoader::MaterialTexPaths texPaths;
+
+        reader.read(mesh.start);
+        reader.read(mesh.count);
+        reader.read(mesh.material.name);
+        reader.read(mesh.material.ambientStrength);
+        reader.read(mesh.material.diffuseStrength);
+        reader.read(mesh.material.specularStrength);
+        reader.read(mesh.material.shininess);
+        reader.read(mesh.material.reflection);
+        reader.read(mesh.material.jitter);
+        reader.read(texPaths.ambient);
+        reader.read(texPaths.diffuse);
+        reader.read(texPaths.specular);
+        reader.read(texPaths.normal);
+        reader.read(texPaths.reflection);
+        reader.read(texPaths.jitter);
+        reader.readArray(mesh.lods);
+        reader.read(mesh.meshletsStart);
+        reader.read(mesh.meshletsCount);
+
+        shape.meshes.push_back(mesh);
+        materialTexPaths.push_back(texPaths);
+    }
+
+    reader.readArray(shape.lodErrors);
+    reader.readArray(shape.meshlets);
+
+    // bones
+    uint bonesCount = 0;
+    reader.read(bonesCount);
+
+    for (uint i = 0; i < bonesCount && reader.isOk(); i++) {
+        string name;
+        glm::mat4 offsetMatrix;
+
+        reader.read(name);
+        reader.read(offsetMatrix);
+
+        shape.bones.emplace_back(name, offsetMatrix);
+    }
+
+    // node tree
+    if (reader.isOk())
+        readNode(reader, shape.rootNode);
+
+    // animations
+    uint animationsCount = 0;
+    reader.read(animationsCount);
+
+    for (uint i = 0; i < animationsCount && reader.isOk(); i++) {
+        Animation animation;
+        uint channelsCount = 0;
+
+        reader.read(animation.name);
+        reader.read(animation.ticksPerSecond);
+        reader.read(animation.duration);
+        reader.read(channelsCount);
+
+        for (uint j = 0; j < channelsCount && reader.isOk(); j++) {
+            AnimNode channel;
+
+            reader.read(channel.name);
+            readKeys(reader, channel.scalingKeys);
+            readKeys(reader, channel.positionKeys);
+            readKeys(reader, channel.rotationKeys);
+
+            animation.channels.push_back(channel);
+        }
+
+        shape.animations.push_back(animation);
+    }
+
+    uint endMarker = 0;
+    if (!reader.read(endMarker) || endMarker != cacheMagic || !reader.isOk()) {
+        cerr << "ShapeCache: " << path << " is corrupted, ignoring it\n";
+        return false;
+    }
+
+    Shape *dst = loader.m_shape;
+    dst->globalInverseTransform = shape.globalInverseTransform;
+    dst->geometry = move(shape.geometry);
+    dst->meshes = move(shape.meshes);
+    dst->lodErrors = move(shape.lodErrors);
+    dst->meshlets = move(shape.meshlets);
+    dst->bones = move(shape.bones);
+    dst->rootNode = move(shape.rootNode);
+    dst->animations = move(shape.animations);
+    loader.m_materialTexPaths = move(materialTexPaths);
+
+    return true;
+}
+}
@@ -0,0 +1,77 @@
+#include <algine/Skeleton.h>
+#include <algine/animation.h>
+
+using namespace std;
+
+namespace algine {
+// name -> index of the first object with this name
+template<typename T>
+inline unordered_map<string, int> getIndices(const vector<T> &objects) {
+    unordered_map<string, int> indices;
+
+    for (usize i = 0; i < objects.size(); i++)
+        indices.insert({objects[i].name, static_cast<int>(i)});
+
+    return indices;
+}
+
+inline int findIndex(const unordered_map<string, int> &indices, const string &name) {
+    auto it = indices.find(name);
+    return it != indices.end() ? it->second : -1;
+}
+
+void Skeleton::build(Node &rootNode, const vector<Bone> &shapeBones, const vector<Animation> &animations) {
+    nodes.clear();
+    names.clear();
+    parents.clear();
+    defaultTransforms.clear();
+    transformations.clear();
+    m_nodeIndices.clear();
+
+    addNode(rootNode, -1);
+
+    // the first bone / channel with the node name is used, as Animator did
+    unordered_map<string, int> boneIndices = getIndices(shapeBones);
+    bones.resize(names.size());
+
+    for (usize i = 0; i < names.size(); i++)
+        bones[i] = findIndex(boneIndices, names[i]);
+
+    channels.resize(animations.size());
+
+    for (usize i = 0; i < animations.size(); i++) {
+        unordered_map<string, int> channelIndices = getIndices(animations[i].channels);
+        channels[i].resize(names.size());
+
+        for (usize j = 0; j < names.size(); j++) {
+            channels[i][j] = findIndex(channelIndices, names[j]);
+        }
+    }
+}
+
+int Skeleton::getNodeIndex(const string &name) const {
+    auto it = m_nodeIndices.find(name);
+    return it != m_nodeIndices.end() ? static_cast<int>(it->second) : -1;
+}
+
+usize Skeleton::getNodesCount() const {
+    return parents.size();
+}
+
+void Skeleton::addNode(Node &node, const int parent) {
+    auto index = static_cast<uint>(parents.size());
+
+    nodes.push_back(&node);
+    names.push_back(node.name);
+    parents.push_back(parent);
+    defaultTransforms.push_back(node.defaultTransform);
+    transformations.push_back(node.transformation);
+
+    // if names repeat, the first node in depth-first order is used
+    m_nodeIndices.insert({node.name, index});
+
+    for (Node &child : node.childs) {
+        addNode(child, static_cast<int>(index));
+    }
+}
+}
@@ -0,0 +1,163 @@
+#include <algine/TextureCache.h>
+
+#include <GL/glew.h>
+#include <functional>
+#include <algorithm>
+
+using namespace std;
+
+namespace algine {
+bool TextureCache::Key::operator==(const Key &other) const {
+    return path == other.path && params == other.params;
+}
+
+inline void hashCombine(usize &seed, const usize value) {
+    seed ^= value + 0x9e3779b9 + (seed << 6u) + (seed >> 2u);
+}
+
+usize TextureCache::KeyHash::operator()(const Key &key) const {
+    usize seed = hash<string>()(key.path);
+
+    for (const auto &param : key.params) {
+        hashCombine(seed, hash<uint>()(param.first));
+        hashCombine(seed, hash<uint>()(param.second));
+    }
+
+    return seed;
+}
+
+TextureCache::TextureCache(const usize budget): m_budget(budget) { /* empty */ }
+
+shared_ptr<Texture2D> TextureCache::get(const Key &key) {
+    lock_guard<mutex> lock(m_mutex);
+
+    auto entry = m_entries.find(key);
+
+    if (entry == m_entries.end())
+        return nullptr;
+
+    m_lru.splice(m_lru.begin(), m_lru, entry->second.lruPosition);
+
+    return entry->second.texture;
+}
+
+shared_ptr<Texture2D> TextureCache::add(const Key &key, const shared_ptr<Texture2D> &texture, const usize size) {
+    lock_guard<mutex> lock(m_mutex);
+
+    auto entry = m_entries.find(key);
+
+    if (entry != m_entries.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, entry->second.lruPosition);
+        return entry->second.texture;
+    }
+
+    m_lru.push_front(key);
+    m_entries[key] = {texture, size, m_lru.begin()};
+    m_size += size;
+
+    if (m_budget != 0)
+        evictLocked(m_budget);
+
+    return texture;
+}
+
+uint TextureCache::evict() {
+    lock_guard<mutex> lock(m_mutex);
+    return m_budget != 0 ? evictLocked(m_budget) : 0;
+}
+
+void TextureCache::clear() {
+    lock_guard<mutex> lock(m_mutex);
+    evictLocked(0);
+}
+
+void TextureCache::setBudget(const usize budget) {
+    lock_guard<mutex> lock(m_mutex);
+    m_budget = budget;
+}
+
+usize TextureCache::getBudget() {
+    lock_guard<mutex> lock(m_mutex);
+    return m_budget;
+}
+
+usize TextureCache::getSize() {
+    lock_guard<mutex> lock(m_mutex);
+    return m_size;
+}
+
+usize TextureCache::getCount() {
+    lock_guard<mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+usize TextureCache::getTextureSize(uint width, uint height, const uint format, const bool mipmaps) {
+    uint bytesPerPixel = getBytesPerPixel(format);
+    usize size = static_cast<usize>(width) * height * bytesPerPixel;
+
+    while (mipmaps && (width > 1 || height > 1)) {
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+        size += static_cast<usize>(width) * height * bytesPerPixel;
+    }
+
+    return size;
+}
+
+uint TextureCache::getBytesPerPixel(const uint format) {
+    switch (format) {
+        case GL_RED:
+        case GL_R8:
+            return 1;
+        case GL_RG:
+        case GL_RG8:
+        case GL_R16:
+        case GL_R16F:
+            return 2;
+        case GL_RGB:
+        case GL_RGBA:
+        case GL_RGB8:
+        case GL_RGBA8:
+        case GL_RG16:
+        case GL_RG16F:
+        case GL_R32F:
+            return 4;
+        case GL_RGB16F:
+        case GL_RGBA16F:
+        case GL_RGBA16:
+        case GL_RG32F:
+            return 8;
+        case GL_RGB32F:
+        case GL_RGBA32F:
+            return 16;
+        default:
+            return 4;
+    }
+}
+
+TextureCache* TextureCache::getDefault() {
+    static TextureCache cache;
+    return &cache;
+}
+
+uint TextureCache::evictLocked(const usize budget) {
+    uint count = 0;
+
+    // from the least recently used
+    for (auto key = m_lru.end(); key != m_lru.begin() && m_size > budget;) {
+        --key;
+        auto entry = m_entries.find(*key);
+
+        // texture is still used by the models
+        if (entry->second.texture.use_count() > 1)
+            continue;
+
+        m_size -= entry->second.size;
+        m_entries.erase(entry);
+        key = m_lru.erase(key);
+        count++;
+    }
+
+    return count;
+}
+}
@@ -0,0 +1,291 @@
+#include <algine/TextureCompressor.h>
+#include <algine/texture.h>
+#include <algine/MipmapGenerator.h>
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+using namespace std;
+
+namespace algine {
+inline uint16 toRGB565(const float *color) {
+    auto r = static_cast<uint>(std::min(color[0], 255.0f) * 31.0f / 255.0f + 0.5f);
+    auto g = static_cast<uint>(std::min(color[1], 255.0f) * 63.0f / 255.0f + 0.5f);
+    auto b = static_cast<uint>(std::min(color[2], 255.0f) * 31.0f / 255.0f + 0.5f);
+
+    return static_cast<uint16>((r << 11u) | (g << 5u) | b);
+}
+
+inline void fromRGB565(const uint16 color, int *result) {
+    uint r = (color >> 11u) & 31u, g = (color >> 5u) & 63u, b = color & 31u;
+
+    result[0] = static_cast<int>((r << 3u) | (r >> 2u));
+    result[1] = static_cast<int>((g << 2u) | (g >> 4u));
+    result[2] = static_cast<int>((b << 3u) | (b >> 2u));
+}
+
+inline void writeUint16(ubyte *dst, const uint16 value) {
+    dst[0] = static_cast<ubyte>(value & 0xffu);
+    dst[1] = static_cast<ubyte>(value >> 8u);
+}
+
+// endpoints are the extreme pixels along the principal axis of the block colors
+void TextureCompressor::encodeBC1Block(const ubyte *rgba, ubyte *block) {
+    float mean[3] = {0, 0, 0};
+
+    for (uint i = 0; i < 16; i++)
+        for (uint c = 0; c < 3; c++)
+            mean[c] += rgba[i * 4 + c] / 16.0f;
+
+    // covariance matrix: xx, xy, xz, yy, yz, zz
+    float cov[6] = {0, 0, 0, 0, 0, 0};
+
+    for (uint i = 0; i < 16; i++) {
+        float r = rgba[i * 4] - mean[0], g = rgba[i * 4 + 1] - mean[1], b = rgba[i * 4 + 2] - mean[2];
+        cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+        cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+    }
+
+    // power iteration
+    float axis[3] = {1, 1, 1};
+
+    for (uint iteration = 0; iteration < 8; iteration++) {
+        float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+        float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+        float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+        float length = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+
+        if (length == 0)
+            break;
+
+        axis[0] = x / length;
+        axis[1] = y / length;
+        axis[2] = z / length;
+    }
+
+    uint minIndex = 0, maxIndex = 0;
+    float minProj = 0, maxProj = 0;
+
+    for (uint i = 0; i < 16; i++) {
+        float proj = rgba[i * 4] * axis[0] + rgba[i * 4 + 1] * axis[1] + rgba[i * 4 + 2] * axis[2];
+
+        if (i == 0 || proj < minProj) {
+            minProj = proj;
+            minIndex = i;
+        }
+
+        if (i == 0 || proj > maxProj) {
+            maxProj = proj;
+            maxIndex = i;
+        }
+    }
+
+    float maxColor[3], minColor[3];
+
+    for (uint c = 0; c < 3; c++) {
+        maxColor[c] = rgba[maxIndex * 4 + c];
+        minColor[c] = rgba[minIndex * 4 + c];
+    }
+
+    uint16 color0 = toRGB565(maxColor), color1 = toRGB565(minColor);
+
+    // color0 > color1 selects 4 colors mode
+    if (color0 < color1)
+        std::swap(color0, color1);
+
+    writeUint16(block, color0);
+    writeUint16(block + 2, color1);
+
+    uint indices = 0;
+
+    if (color0 != color1) {
+        int palette[4][3];
+        fromRGB565(color0, palette[0]);
+        fromRGB565(color1, palette[1]);
+
+        for (uint c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (uint i = 0; i < 16; i++) {
+            uint best = 0;
+            int bestDistance = 0;
+
+            for (uint p = 0; p < 4; p++) {
+                int distance = 0;
+
+                for (uint c = 0; c < 3; c++) {
+                    int d = rgba[i * 4 + c] - palette[p][c];
+                    distance += d * d;
+                }
+
+                if (p == 0 || distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+
+            indices |= best << (i * 2);
+        }
+    }
+
+    for (uint i = 0; i < 4; i++)
+        block[4 + i] = static_cast<ubyte>((indices >> (i * 8)) & 0xffu);
+}
+
+void TextureCompressor::encodeBC4Block(const ubyte *values, const uint stride, ubyte *block) {
+    int value0 = 0, value1 = 255;
+
+    for (uint i = 0; i < 16; i++) {
+        value0 = std::max(value0, static_cast<int>(values[i * stride]));
+        value1 = std::min(value1, static_cast<int>(values[i * stride]));
+    }
+
+    block[0] = static_cast<ubyte>(value0);
+    block[1] = static_cast<ubyte>(value1);
+
+    uint64 indices = 0;
+
+    // value0 > value1 selects 8 values mode: 0 - value0, 1 - value1, 2..7 - interpolated
+    if (value0 != value1) {
+        int palette[8] = {value0, value1};
+
+        for (int p = 1; p < 7; p++)
+            palette[p + 1] = ((7 - p) * value0 + p * value1) / 7;
+
+        for (uint i = 0; i < 16; i++) {
+            uint best = 0;
+            int bestDistance = 256;
+
+            for (uint p = 0; p < 8; p++) {
+                int distance = std::abs(values[i * stride] - palette[p]);
+
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+
+            indices |= static_cast<uint64>(best) << (i * 3);
+        }
+    }
+
+    for (uint i = 0; i < 6; i++)
+        block[2 + i] = static_cast<ubyte>((indices >> (i * 8)) & 0xffu);
+}
+
+void TextureCompressor::encodeBC3Block(const ubyte *rgba, ubyte *block) {
+    encodeBC4Block(rgba + 3, 4, block);
+    encodeBC1Block(rgba, block + 8);
+}
+
+void TextureCompressor::encodeBC5Block(const ubyte *rgba, ubyte *block) {
+    encodeBC4Block(rgba, 4, block);
+    encodeBC4Block(rgba + 1, 4, block + 8);
+}
+
+uint TextureCompressor::getBlockSize(const uint format) {
+    switch (format) {
+        case Texture::BC1:
+            return 8;
+        case Texture::BC3:
+        case Texture::BC5:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+bool TextureCompressor::hasAlpha(const Image &image) {
+    if (image.channels != 4)
+        return false;
+
+    for (usize i = 0; i < static_cast<usize>(image.width) * image.height; i++)
+        if (image.data[i * 4 + 3] != 255)
+            return true;
+
+    return false;
+}
+
+// expands image to RGBA8 in the same way as GL does: missing color components are 0, alpha is 255
+inline vector<ubyte> toRGBA(const Image &image) {
+    usize pixelsCount = static_cast<usize>(image.width) * image.height;
+    vector<ubyte> rgba(pixelsCount * 4, 0);
+
+    for (usize i = 0; i < pixelsCount; i++) {
+        for (uint c = 0; c < image.channels; c++)
+            rgba[i * 4 + c] = image.data[i * image.channels + c];
+
+        if (image.channels < 4)
+            rgba[i * 4 + 3] = 255;
+    }
+
+    return rgba;
+}
+
+inline void compressLevel(const vector<ubyte> &rgba, const uint width, const uint height,
+        const uint format, CompressedImage::Level &level)
+{
+    uint blockSize = TextureCompressor::getBlockSize(format);
+    uint blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+
+    level.width = width;
+    level.height = height;
+    level.data.resize(static_cast<usize>(blocksX) * blocksY * blockSize);
+
+    ubyte pixels[16 * 4];
+
+    for (uint by = 0; by < blocksY; by++) {
+        for (uint bx = 0; bx < blocksX; bx++) {
+            // edge blocks are filled with clamped pixels
+            for (uint py = 0; py < 4; py++) {
+                uint y = std::min(by * 4 + py, height - 1);
+
+                for (uint px = 0; px < 4; px++) {
+                    uint x = std::min(bx * 4 + px, width - 1);
+                    memcpy(pixels + (py * 4 + px) * 4, &rgba[(static_cast<usize>(y) * width + x) * 4], 4);
+                }
+            }
+
+            ubyte *block = &level.data[(static_cast<usize>(by) * blocksX + bx) * blockSize];
+
+            switch (format) {
+                case Texture::BC1:
+                    TextureCompressor::encodeBC1Block(pixels, block);
+                    break;
+                case Texture::BC3:
+                    TextureCompressor::encodeBC3Block(pixels, block);
+                    break;
+                case Texture::BC5:
+                    TextureCompressor::encodeBC5Block(pixels, block);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+bool TextureCompressor::compress(const Image &image, const uint format, CompressedImage &result,
+        const uint mipmapFilter, const uint mipmapFlags)
+{
+    if (!image.data || getBlockSize(format) == 0)
+        return false;
+
+    vector<ubyte> rgba = toRGBA(image);
+    vector<MipmapGenerator::Level> mipmaps =
+            MipmapGenerator::generate(rgba.data(), image.width, image.height, 4, mipmapFilter, mipmapFlags);
+
+    result.format = format;
+    result.levels.resize(mipmaps.size() + 1);
+
+    compressLevel(rgba, image.width, image.height, format, result.levels[0]);
+
+    for (usize i = 0; i < mipmaps.size(); i++)
+        compressLevel(mipmaps[i].data, mipmaps[i].width, mipmaps[i].height, format, result.levels[i + 1]);
+
+    return true;
+}
+}
@@ -0,0 +1,72 @@
+#include <algine/ThreadPool.h>
+
+namespace algine {
+ThreadPool::ThreadPool(uint threadsCount) {
+    // hardware_concurrency() may return 0 if the value is not computable
+    if (threadsCount == 0)
+        threadsCount = 1;
+
+    m_threads.reserve(threadsCount);
+    for (uint i = 0; i < threadsCount; i++)
+        m_threads.emplace_back(&ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_condition.notify_all();
+
+    for (std::thread &thread : m_threads)
+        thread.join();
+}
+
+bool ThreadPool::runPendingTask() {
+    std::function<void()> task;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_tasks.empty())
+            return false;
+
+        task = std::move(m_tasks.front());
+        m_tasks.pop();
+    }
+
+    task();
+
+    return true;
+}
+
+uint ThreadPool::getThreadsCount() const {
+    return m_threads.size();
+}
+
+ThreadPool* ThreadPool::getDefault() {
+    static ThreadPool pool;
+    return &pool;
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+
+            // remaining tasks are completed before stop
+            if (m_tasks.empty())
+                return;
+
+            task = std::move(m_tasks.front());
+            m_tasks.pop();
+        }
+
+        task();
+    }
+}
+}
@@ -0,0 +1,86 @@
+#include <algine/VertexQuantizer.h>
+
+#include <cstring>
+#include <cmath>
+
+namespace algine {
+uint16 VertexQuantizer::toHalf(const float value) {
+    uint bits;
+    memcpy(&bits, &value, sizeof(float));
+
+    uint sign = (bits >> 16u) & 0x8000u;
+    uint exponent = (bits >> 23u) & 0xffu;
+    uint mantissa = bits & 0x7fffffu;
+
+    // NaN & Inf
+    if (exponent == 0xffu)
+        return static_cast<uint16>(sign | 0x7c00u | (mantissa != 0 ? 0x200u : 0));
+
+    int halfExponent = static_cast<int>(exponent) - 127 + 15;
+
+    // overflow: Inf
+    if (halfExponent >= 31)
+        return static_cast<uint16>(sign | 0x7c00u);
+
+    // underflow: denormalized half or zero
+    if (halfExponent <= 0) {
+        if (halfExponent < -10)
+            return static_cast<uint16>(sign);
+
+        mantissa |= 0x800000u;
+        uint shift = static_cast<uint>(14 - halfExponent);
+        uint result = mantissa >> shift;
+
+        // round to nearest
+        if ((mantissa >> (shift - 1)) & 1u)
+            result++;
+
+        return static_cast<uint16>(sign | result);
+    }
+
+    uint result = sign | (static_cast<uint>(halfExponent) << 10u) | (mantissa >> 13u);
+
+    // round to nearest, mantissa overflow moves to exponent
+    if (mantissa & 0x1000u)
+        result++;
+
+    return static_cast<uint16>(result);
+}
+
+uint16 VertexQuantizer::toUnorm16(const float value) {
+    float clamped = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<uint16>(clamped * 65535.0f + 0.5f);
+}
+
+int16 VertexQuantizer::toSnorm16(const float value) {
+    float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+    return static_cast<int16>(std::round(clamped * 32767.0f));
+}
+
+inline float signNotZero(const float value) {
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+void VertexQuantizer::toOctahedral(const float *vector, int16 *result) {
+    float length = std::fabs(vector[0]) + std::fabs(vector[1]) + std::fabs(vector[2]);
+
+    if (length == 0.0f) {
+        result[0] = result[1] = 0;
+        return;
+    }
+
+    float x = vector[0] / length;
+    float y = vector[1] / length;
+
+    // lower hemisphere is folded over the diagonals
+    if (vector[2] < 0.0f) {
+        float foldedX = (1.0f - std::fabs(y)) * signNotZero(x);
+        float foldedY = (1.0f - std::fabs(x)) * signNotZero(y);
+        x = foldedX;
+        y = foldedY;
+    }
+
+    result[0] = toSnorm16(x);
+    result[1] = toSnorm16(y);
+}
+}
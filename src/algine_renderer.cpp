@@ -18,6 +18,13 @@ void pointer(const int location, const int count, const uint buffer, const uint
     );
 }
 
+void pointer(const int location, const int count, const uint buffer, const uint type, const bool normalized,
+        const uint stride, const void *offset)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(location, count, type, normalized ? GL_TRUE : GL_FALSE, stride, offset);
+}
+
 void pointerui(const int location, const int count, const uint buffer, const uint stride, const void *offset) {
     glBindBuffer(GL_ARRAY_BUFFER, buffer);
     glVertexAttribIPointer(
@@ -29,6 +36,13 @@ void pointerui(const int location, const int count, const uint buffer, const uin
     );
 }
 
+void pointerui(const int location, const int count, const uint buffer, const uint type, const uint stride,
+        const void *offset)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribIPointer(location, count, type, stride, offset);
+}
+
 // if `inPosLocation` != -1, VAO will be created
 void CubeRenderer::init(const int inPosLocation) {
     // source: https://stackoverflow.com/questions/28375338/cube-using-single-gl-triangle-strip
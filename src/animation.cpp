@@ -6,6 +6,7 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <glm/gtx/quaternion.hpp>
 
 #include <algine/types.h>
@@ -18,6 +19,8 @@
 
 namespace algine {
 // struct VecAnimKey
+VecAnimKey::VecAnimKey() = default;
+
 VecAnimKey::VecAnimKey(const aiVectorKey *key) {
     time = key->mTime;
     value = glm::vec3(key->mValue.x, key->mValue.y, key->mValue.z);
@@ -28,6 +31,8 @@ float VecAnimKey::getTime() {
 }
 
 // struct QuatAnimKey
+QuatAnimKey::QuatAnimKey() = default;
+
 QuatAnimKey::QuatAnimKey(const aiQuatKey *key) {
     time = key->mTime;
     value = glm::quat(key->mValue.w, key->mValue.x, key->mValue.y, key->mValue.z);
@@ -38,6 +43,8 @@ float QuatAnimKey::getTime() {
 }
 
 // struct AnimNode
+AnimNode::AnimNode() = default;
+
 AnimNode::AnimNode(const aiNodeAnim *nodeAnim) {
     name = nodeAnim->mNodeName.data;
     // allocating space for scaling, position, rotation keys
@@ -51,6 +58,8 @@ AnimNode::AnimNode(const aiNodeAnim *nodeAnim) {
 }
 
 // struct Animation
+Animation::Animation() = default;
+
 Animation::Animation(const aiAnimation *anim) {
     ticksPerSecond = anim->mTicksPerSecond;
     duration = anim->mDuration;
@@ -62,11 +71,14 @@ Animation::Animation(const aiAnimation *anim) {
 // struct AnimShape
 AnimShape::AnimShape() { /* empty */ }
 
-AnimShape::AnimShape(std::vector<Animation> *animations, std::vector<Bone> *bones, glm::mat4 *globalInverseTransform, Node *rootNode) {
+AnimShape::AnimShape(std::vector<Animation> *animations, std::vector<Bone> *bones, glm::mat4 *globalInverseTransform, Node *rootNode,
+        Skeleton *skeleton)
+{
     this->animations = animations;
     this->bones = bones;
     this->globalInverseTransform = globalInverseTransform;
     this->rootNode = rootNode;
+    this->skeleton = skeleton;
 }
 
 // struct Animator
@@ -85,41 +97,170 @@ void Animator::animate(const float timeInSeconds) {
     float timeInTicks = timeInSeconds * ticksPerSecond;
     float animationTime = fmod(timeInTicks, shape.animations->operator[](animationIndex).duration);
 
-    readNodeHeirarchy(animationTime, *shape.rootNode, identity);
+    if (shape.skeleton != nullptr && shape.skeleton->getNodesCount() != 0) {
+        animateSkeleton(animationTime);
+    } else {
+        readNodeHeirarchy(animationTime, *shape.rootNode, identity);
+    }
 }
 
-// static
-usize Animator::findPosition(const float animationTime, const AnimNode *animNode) {
-    assert(animNode->positionKeys.size() > 0);
-        
-    for (usize i = 0; i < animNode->positionKeys.size() - 1; i++) {
-        if (animationTime < (float)animNode->positionKeys[i + 1].time) {
-            return i;
+void Animator::animate(const float timeInSeconds, std::vector<glm::mat4> &palette) {
+    if (skinningMode == DualQuaternionSkinning) {
+        palette.resize((shape.bones->size() + 1) / 2);
+    } else {
+        palette.resize(shape.bones->size());
+    }
+
+    m_palette = &palette;
+    animate(timeInSeconds);
+    m_palette = nullptr;
+}
+
+void Animator::setBoneTransformation(const usize index, const glm::mat4 &transformation) {
+    if (m_palette != nullptr && skinningMode == DualQuaternionSkinning) {
+        glm::mat4 &dst = m_palette->operator[](index / 2);
+        usize column = index % 2 * 2;
+
+        // rotation without scaling
+        glm::mat3 rotation = glm::mat3(transformation);
+        rotation[0] = glm::normalize(rotation[0]);
+        rotation[1] = glm::normalize(rotation[1]);
+        rotation[2] = glm::normalize(rotation[2]);
+
+        glm::vec3 translation = glm::vec3(transformation[3]);
+        glm::quat real = glm::quat_cast(rotation);
+        glm::quat dual = glm::quat(0.0f, translation.x, translation.y, translation.z) * real * 0.5f;
+
+        dst[column] = glm::vec4(real.x, real.y, real.z, real.w);
+        dst[column + 1] = glm::vec4(dual.x, dual.y, dual.z, dual.w);
+    } else if (m_palette != nullptr) {
+        m_palette->operator[](index) = transformation;
+    } else {
+        shape.bones->operator[](index).finalTransformation = transformation;
+    }
+}
+
+void Animator::animateSkeleton(const float animationTime) {
+    const Skeleton &skeleton = *shape.skeleton;
+    const Animation &animation = shape.animations->operator[](animationIndex);
+    const std::vector<int> &channels = skeleton.channels[animationIndex];
+    const std::vector<Bone> &bones = *shape.bones;
+
+    if (m_cursorsAnimation != animationIndex || m_cursors.size() != animation.channels.size()) {
+        m_cursors.assign(animation.channels.size(), ChannelCursor());
+        m_cursorsAnimation = animationIndex;
+    }
+
+    m_globalTransforms.resize(skeleton.getNodesCount());
+
+    // parents precede children, so parent global transform is already computed
+    for (usize i = 0; i < skeleton.getNodesCount(); i++) {
+        const glm::mat4 &transformation = skeleton.transformations[i];
+        glm::mat4 nodeTransformation;
+
+        if (channels[i] != -1) {
+            const AnimNode *animNode = &animation.channels[channels[i]];
+            ChannelCursor &cursor = m_cursors[channels[i]];
+
+            glm::vec3 scaling, translation;
+            glm::quat rotationQ;
+            calcInterpolatedScaling(scaling, animationTime, animNode, cursor.scaling);
+            calcInterpolatedRotation(rotationQ, animationTime, animNode, cursor.rotation);
+            calcInterpolatedPosition(translation, animationTime, animNode, cursor.position);
+
+            // translation * rotation * scaling
+            nodeTransformation = glm::toMat4(rotationQ);
+            nodeTransformation[0] *= scaling.x;
+            nodeTransformation[1] *= scaling.y;
+            nodeTransformation[2] *= scaling.z;
+            nodeTransformation[3] = glm::vec4(translation, 1.0f);
+        } else {
+            nodeTransformation = skeleton.defaultTransforms[i] * transformation;
+        }
+
+        int parent = skeleton.parents[i];
+        glm::mat4 &globalTransformation = m_globalTransforms[i];
+        globalTransformation = nodeTransformation * transformation;
+
+        if (parent != -1)
+            globalTransformation = m_globalTransforms[parent] * globalTransformation;
+
+        if (skeleton.bones[i] != -1) {
+            const Bone &bone = bones[skeleton.bones[i]];
+            setBoneTransformation(skeleton.bones[i], *shape.globalInverseTransform * globalTransformation * bone.offsetMatrix);
+        }
+    }
+}
+
+// the cursor is advanced linearly by this number of keys at most, then binary search is used
+constexpr usize maxCursorSteps = 4;
+
+// returns index i of the key, that keys[i].time <= animationTime < keys[i + 1].time
+template<typename T>
+inline usize findKey(const std::vector<T> &keys, const float animationTime, usize &cursor) {
+    if (keys.size() < 2)
+        return cursor = 0;
+
+    usize last = keys.size() - 1;
+
+    // time goes forward: advancing from the last used key
+    if (cursor < last && (float)keys[cursor].time <= animationTime) {
+        usize end = std::min(cursor + maxCursorSteps, last);
+
+        for (; cursor < end; ++cursor) {
+            if (animationTime < (float)keys[cursor + 1].time) {
+                return cursor;
+            }
         }
+
+        if (cursor == last)
+            return cursor = last - 1; // after the last key
     }
 
-    assert(0);
+    // seek or loop
+    auto next = std::upper_bound(keys.begin() + 1, keys.end(), animationTime, [](const float time, const T &key) {
+        return time < (float)key.time;
+    });
+
+    cursor = std::min<usize>(next - keys.begin() - 1, last - 1);
+
+    return cursor;
+}
+
+template<typename T>
+inline float getFactor(const std::vector<T> &keys, const usize index, const float animationTime) {
+    float deltaTime = (float)(keys[index + 1].time - keys[index].time);
+    float factor = (animationTime - (float)keys[index].time) / deltaTime;
+    #ifdef mkAssert
+    assert(factor >= 0.0f && factor <= 1.0f);
+    #endif
+    return factor;
+}
 
-    return 0;
+// static
+usize Animator::findPosition(const float animationTime, const AnimNode *animNode) {
+    assert(animNode->positionKeys.size() > 0);
+    usize cursor = 0;
+    return findKey(animNode->positionKeys, animationTime, cursor);
 }
 
 // static
 void Animator::calcInterpolatedPosition(glm::vec3 &out, const float animationTime, const AnimNode *animNode) {
+    usize cursor = 0;
+    calcInterpolatedPosition(out, animationTime, animNode, cursor);
+}
+
+// static
+void Animator::calcInterpolatedPosition(glm::vec3 &out, const float animationTime, const AnimNode *animNode, usize &cursor) {
     if (animNode->positionKeys.size() == 1) {
         out = animNode->positionKeys[0].value;
         return;
     }
 
-    usize positionIndex = findPosition(animationTime, animNode);
-    usize nextPositionIndex = positionIndex + 1;
-    assert(nextPositionIndex < animNode->positionKeys.size());
-    float deltaTime = (float)(animNode->positionKeys[nextPositionIndex].time - animNode->positionKeys[positionIndex].time);
-    float factor = (animationTime - (float)animNode->positionKeys[positionIndex].time) / deltaTime;
-    #ifdef mkAssert
-    assert(factor >= 0.0f && factor <= 1.0f);
-    #endif
+    usize positionIndex = findKey(animNode->positionKeys, animationTime, cursor);
+    float factor = getFactor(animNode->positionKeys, positionIndex, animationTime);
     const glm::vec3 &start = animNode->positionKeys[positionIndex].value;
-    const glm::vec3 &end = animNode->positionKeys[nextPositionIndex].value;
+    const glm::vec3 &end = animNode->positionKeys[positionIndex + 1].value;
     glm::vec3 delta = end - start;
     out = start + factor * delta;
 }
@@ -127,36 +268,28 @@ void Animator::calcInterpolatedPosition(glm::vec3 &out, const float animationTim
 // static
 usize Animator::findRotation(const float animationTime, const AnimNode *animNode) {
     assert(animNode->rotationKeys.size() > 0);
-        
-    for (usize i = 0; i < animNode->rotationKeys.size() - 1; i++) {
-        if (animationTime < (float)animNode->rotationKeys[i + 1].time) {
-            return i;
-        }
-    }
-
-    assert(0);
-
-    return 0;
+    usize cursor = 0;
+    return findKey(animNode->rotationKeys, animationTime, cursor);
 }
 
 // static
 void Animator::calcInterpolatedRotation(glm::quat &out, const float animationTime, const AnimNode *animNode) {
+    usize cursor = 0;
+    calcInterpolatedRotation(out, animationTime, animNode, cursor);
+}
+
+// static
+void Animator::calcInterpolatedRotation(glm::quat &out, const float animationTime, const AnimNode *animNode, usize &cursor) {
     // we need at least two values to interpolate...
     if (animNode->rotationKeys.size() == 1) {
         out = animNode->rotationKeys[0].value;
         return;
     }
 
-    usize rotationIndex = findRotation(animationTime, animNode);
-    usize nextRotationIndex = rotationIndex + 1;
-    assert(nextRotationIndex < animNode->rotationKeys.size());
-    float deltaTime = (float)(animNode->rotationKeys[nextRotationIndex].time - animNode->rotationKeys[rotationIndex].time);
-    float factor = (animationTime - (float)animNode->rotationKeys[rotationIndex].time) / deltaTime;
-    #ifdef mkAssert
-    assert(factor >= 0.0f && factor <= 1.0f);
-    #endif
+    usize rotationIndex = findKey(animNode->rotationKeys, animationTime, cursor);
+    float factor = getFactor(animNode->rotationKeys, rotationIndex, animationTime);
     const glm::quat &startRotationQ = animNode->rotationKeys[rotationIndex].value;
-    const glm::quat &endRotationQ   = animNode->rotationKeys[nextRotationIndex].value;
+    const glm::quat &endRotationQ   = animNode->rotationKeys[rotationIndex + 1].value;
     out = glm::slerp(startRotationQ, endRotationQ, factor); // aiQuaternion::Interpolate
     out = glm::normalize(out);
 }
@@ -164,35 +297,27 @@ void Animator::calcInterpolatedRotation(glm::quat &out, const float animationTim
 // static
 usize Animator::findScaling(const float animationTime, const AnimNode *animNode) {
     assert(animNode->scalingKeys.size() > 0);
-       
-    for (usize i = 0; i < animNode->scalingKeys.size() - 1; i++) {
-        if (animationTime < (float)animNode->scalingKeys[i + 1].time) {
-            return i;
-        }
-    }
-
-    assert(0);
-
-    return 0;
+    usize cursor = 0;
+    return findKey(animNode->scalingKeys, animationTime, cursor);
 }
 
 // static
 void Animator::calcInterpolatedScaling(glm::vec3 &out, const float animationTime, const AnimNode *animNode) {
+    usize cursor = 0;
+    calcInterpolatedScaling(out, animationTime, animNode, cursor);
+}
+
+// static
+void Animator::calcInterpolatedScaling(glm::vec3 &out, const float animationTime, const AnimNode *animNode, usize &cursor) {
     if (animNode->scalingKeys.size() == 1) {
         out = animNode->scalingKeys[0].value;
         return;
     }
 
-    usize scalingIndex = findScaling(animationTime, animNode);
-    usize nextScalingIndex = scalingIndex + 1;
-    assert(nextScalingIndex < animNode->scalingKeys.size());
-    float deltaTime = (float)(animNode->scalingKeys[nextScalingIndex].time - animNode->scalingKeys[scalingIndex].time);
-    float factor = (animationTime - (float)animNode->scalingKeys[scalingIndex].time) / deltaTime;
-    #ifdef mkAssert
-    assert(factor >= 0.0f && factor <= 1.0f);
-    #endif
+    usize scalingIndex = findKey(animNode->scalingKeys, animationTime, cursor);
+    float factor = getFactor(animNode->scalingKeys, scalingIndex, animationTime);
     const glm::vec3 &start = animNode->scalingKeys[scalingIndex].value;
-    const glm::vec3 &end = animNode->scalingKeys[nextScalingIndex].value;
+    const glm::vec3 &end = animNode->scalingKeys[scalingIndex + 1].value;
     glm::vec3 delta = end - start;
     out = start + factor * delta;
 }
@@ -216,21 +341,29 @@ void Animator::readNodeHeirarchy(const float animationTime, const Node &node, co
     glm::mat4 nodeTransformation = node.defaultTransform * node.transformation; // WARNING: experimental feature "node.transformation"
     const AnimNode *animNode = findNodeAnim(&animation, nodeName);
 
+    // cursors are valid only for the animation they were created for
+    if (m_cursorsAnimation != animationIndex || m_cursors.size() != animation.channels.size()) {
+        m_cursors.assign(animation.channels.size(), ChannelCursor());
+        m_cursorsAnimation = animationIndex;
+    }
+
     if (animNode) {
+        ChannelCursor &cursor = m_cursors[animNode - animation.channels.data()];
+
         // Интерполируем масштабирование и генерируем матрицу преобразования масштаба
         glm::vec3 scaling;
-        calcInterpolatedScaling(scaling, animationTime, animNode);
+        calcInterpolatedScaling(scaling, animationTime, animNode, cursor.scaling);
         glm::mat4 scalingM;
         scalingM = glm::scale(scalingM, scaling);
 
         // Интерполируем вращение и генерируем матрицу вращения
         glm::quat rotationQ;
-        calcInterpolatedRotation(rotationQ, animationTime, animNode);
+        calcInterpolatedRotation(rotationQ, animationTime, animNode, cursor.rotation);
         glm::mat4 rotationM = glm::toMat4(rotationQ);
 
         //  Интерполируем смещение и генерируем матрицу смещения
         glm::vec3 translation;
-        calcInterpolatedPosition(translation, animationTime, animNode);
+        calcInterpolatedPosition(translation, animationTime, animNode, cursor.position);
         glm::mat4 translationM;
         translationM = glm::translate(translationM, translation);
             
@@ -244,7 +377,7 @@ void Animator::readNodeHeirarchy(const float animationTime, const Node &node, co
 
     for (usize i = 0; i < shape.bones->size(); i++) {
         if (shape.bones->operator[](i).name == nodeName) {
-            shape.bones->operator[](i).finalTransformation = *shape.globalInverseTransform * globalTransformation * shape.bones->operator[](i).offsetMatrix;
+            setBoneTransformation(i, *shape.globalInverseTransform * globalTransformation * shape.bones->operator[](i).offsetMatrix);
             break;
         }
     }
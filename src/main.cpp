@@ -18,6 +18,12 @@
 #include <assimp/postprocess.h>
 #include <tulz/Path>
 
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
 #include <algine/algine_renderer.h>
 #include <algine/framebuffer.h>
 #include <algine/light.h>
@@ -29,6 +35,9 @@
 #include <algine/event.h>
 #include <algine/shader.h>
 #include <algine/texture.h>
+#include <algine/GeometryHeap.h>
+#include <algine/AnimationBatch.h>
+#include <algine/BonePaletteBuffer.h>
 
 #define SHADOW_MAP_RESOLUTION 1024
 #define bloomK 0.5f
@@ -48,12 +57,24 @@
 #define pointLightsLimit 8u
 #define dirLightsLimit 8u
 #define maxBoneAttribsPerVertex 1u
-#define maxBones 64u
+// optional ShapeLoader features, the demo uses the baseline params if all are disabled
+#define interleaveBuffers false
+#define optimizeMeshes false
+#define generateLods false
+#define buildMeshlets false
+#define quantizeVertices false
+#define compressTextures false
+#define quantizeBones false
+#define releaseGeometry false // geometry isn't used on CPU after loading
+#define dualQuaternionSkinning false // ignores bones scaling, see Animator::DualQuaternionSkinning
 // point light texture start id
 #define POINT_LIGHT_TSID 6
 // dir light texture start id
 #define DIR_LIGHT_TSID (int)(POINT_LIGHT_TSID + pointLightsLimit)
+#define BONES_TSID (int)(DIR_LIGHT_TSID + dirLightsLimit)
 #define SHAPES_COUNT 4
+// compressed textures cache, outside of the resources tree
+#define TEXTURES_CACHE_PATH "cache/textures"
 #define MODELS_COUNT 3
 
 // Function prototypes
@@ -77,6 +98,9 @@ using namespace std;
 shared_ptr<Shape> shapes[SHAPES_COUNT];
 Model models[MODELS_COUNT], lamps[pointLampsCount + dirLampsCount];
 Animator manAnimator, astroboyAnimator; // animator for man, astroboy models
+GeometryHeap *geometryHeap; // shared vertex & index buffers of all shapes
+AnimationBatch animationBatch; // evaluates poses of the animated models on the thread pool
+BonePaletteBuffer *bonePalette; // bone palettes of the animated models
 
 // light
 PointLamp pointLamps[pointLampsCount];
@@ -246,19 +270,37 @@ void createDirLamp(DirLamp &result,
 }
 
 void
-createShapes(const string &path, const string &texPath, const size_t id, const bool inverseNormals = false,
-             uint bonesPerVertex = 0) {
-    ShapeLoader shapeLoader;
+initShapeLoader(ShapeLoader &shapeLoader, const string &path, const string &texPath, const bool inverseNormals = false,
+                uint bonesPerVertex = 0) {
     shapeLoader.setModelPath(path);
     shapeLoader.setTexturesPath(texPath);
+    shapeLoader.setCachePath(path + ".cache");
+    shapeLoader.setTexturesCachePath(TEXTURES_CACHE_PATH);
+    shapeLoader.setGeometryHeap(geometryHeap);
+    if (releaseGeometry)
+        shapeLoader.setGeometryRetention(ShapeLoader::ReleaseGeometry);
     if (inverseNormals)
         shapeLoader.addParam(ShapeLoader::InverseNormals);
     shapeLoader.addParams(ShapeLoader::Triangulate, ShapeLoader::SortByPolygonType,
             ShapeLoader::CalcTangentSpace, ShapeLoader::JoinIdenticalVertices);
+    if (interleaveBuffers)
+        shapeLoader.addParam(ShapeLoader::InterleaveBuffers);
+    if (optimizeMeshes)
+        shapeLoader.addParam(ShapeLoader::OptimizeMeshes);
+    if (generateLods)
+        shapeLoader.addParam(ShapeLoader::GenerateLods);
+    if (buildMeshlets)
+        shapeLoader.addParam(ShapeLoader::BuildMeshlets);
+    if (quantizeVertices)
+        shapeLoader.addParam(ShapeLoader::QuantizeVertices);
+    if (compressTextures)
+        shapeLoader.addParam(ShapeLoader::CompressTextures);
+    if (quantizeBones)
+        shapeLoader.addParam(ShapeLoader::QuantizeBones);
     shapeLoader.getShape()->bonesPerVertex = bonesPerVertex;
-    shapeLoader.load();
+}
 
-    shapes[id].reset(shapeLoader.getShape());
+void createShapeVAOs(const size_t id) {
     shapes[id]->createVAO(
             pointShadowShader->getLocation(AlgineNames::ShadowShader::InPos),
             -1, -1, -1, -1,
@@ -364,7 +406,8 @@ void initShaders() {
         manager.define(Lighting::PointLightsLimit, std::to_string(pointLightsLimit));
         manager.define(Lighting::DirLightsLimit, std::to_string(dirLightsLimit));
         manager.define(MaxBoneAttribsPerVertex, std::to_string(maxBoneAttribsPerVertex));
-        manager.define(MaxBones, std::to_string(maxBones));
+        if (dualQuaternionSkinning)
+            manager.define(DualQuaternionSkinning);
         colorShader->fromSource(manager.makeGenerated());
         colorShader->loadActiveLocations();
 
@@ -375,7 +418,8 @@ void initShaders() {
         manager.resetDefinitions();
         manager.define(BoneSystem);
         manager.define(MaxBoneAttribsPerVertex, std::to_string(maxBoneAttribsPerVertex));
-        manager.define(MaxBones, std::to_string(maxBones));
+        if (dualQuaternionSkinning)
+            manager.define(DualQuaternionSkinning);
         manager.define(ShadowShader::PointLightShadowMapping);
         pointShadowShader->fromSource(manager.makeGenerated());
         pointShadowShader->loadActiveLocations();
@@ -649,16 +693,59 @@ void initCamera() {
     camController.camera = &camera;
 }
 
+// creates directory if it doesn't exist, parent directory must exist
+inline void makeDirectory(const string &path) {
+#ifdef _WIN32
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+}
+
 /**
  * Creating shapes and loading textures
  */
 void initShapes() {
     string path = "src/resources/models/";
+    ShapeLoader shapeLoaders[SHAPES_COUNT];
+    geometryHeap = new GeometryHeap();
+
+    makeDirectory("cache");
+    makeDirectory(TEXTURES_CACHE_PATH);
+
+    initShapeLoader(shapeLoaders[0], path + "chess/Classic Chess small.obj", path + "chess", false, 0); // classic chess
+    initShapeLoader(shapeLoaders[1], path + "japanese_lamp/japanese_lamp.obj", path + "japanese_lamp", true, 0); // Japanese lamp
+    initShapeLoader(shapeLoaders[2], path + "man/man.dae", path + "man", false, 4); // animated man
+    initShapeLoader(shapeLoaders[3], path + "astroboy/astroboy_walk.dae", path + "astroboy", false, 4);
+
+    // cooked assets are used if the pack exists, see algine_pack tool
+    AssetPack assetPack;
+    string packPath = path + "models.pack";
+    if (tulz::Path(packPath).exists() && assetPack.open(packPath)) {
+        for (auto &shapeLoader : shapeLoaders) {
+            shapeLoader.setAssetPack(&assetPack);
+        }
+    }
 
-    createShapes(path + "chess/Classic Chess small.obj", path + "chess", 0, false, 0); // classic chess
-    createShapes(path + "japanese_lamp/japanese_lamp.obj", path + "japanese_lamp", 1, true, 0); // Japanese lamp
-    createShapes(path + "man/man.dae", path + "man", 2, false, 4); // animated man
-    createShapes(path + "astroboy/astroboy_walk.dae", path + "astroboy", 3, false, 4);
+    std::future<bool> loaded[SHAPES_COUNT];
+    for (size_t i = 0; i < SHAPES_COUNT; i++)
+        loaded[i] = shapeLoaders[i].loadAsync();
+
+    // uploads are processed in per-frame slices, so the window stays responsive while loading
+    for (size_t i = 0; i < SHAPES_COUNT; i++) {
+        while (loaded[i].wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            GLUploadQueue::getDefault()->process();
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glfwPollEvents();
+            glfwSwapBuffers(window);
+        }
+
+        shapes[i].reset(shapeLoaders[i].getShape());
+        createShapeVAOs(i);
+
+        if (releaseGeometry)
+            std::cout << "Shape " << i << ": " << shapeLoaders[i].getReleasedGeometrySize() / 1024 << " KiB of geometry released\n";
+    }
 }
 
 /**
@@ -670,7 +757,8 @@ void createModels() {
     models[0].shape = shapes[0].get();
 
     // animated man
-    manAnimator = Animator(AnimShape(&shapes[2]->animations, &shapes[2]->bones, &shapes[2]->globalInverseTransform, &shapes[2]->rootNode));
+    manAnimator = Animator(AnimShape(&shapes[2]->animations, &shapes[2]->bones, &shapes[2]->globalInverseTransform, &shapes[2]->rootNode,
+            &shapes[2]->skeleton));
     models[1] = Model(Rotator::RotatorTypeSimple);
     models[1].shape = shapes[2].get();
     models[1].setPitch(glm::radians(-90.0f));
@@ -681,7 +769,8 @@ void createModels() {
     models[1].animator = &manAnimator;
 
     // animated astroboy
-    astroboyAnimator = Animator(AnimShape(&shapes[3]->animations, &shapes[3]->bones, &shapes[3]->globalInverseTransform, &shapes[3]->rootNode));
+    astroboyAnimator = Animator(AnimShape(&shapes[3]->animations, &shapes[3]->bones, &shapes[3]->globalInverseTransform, &shapes[3]->rootNode,
+            &shapes[3]->skeleton));
     models[2] = Model(Rotator::RotatorTypeSimple);
     models[2].shape = shapes[3].get();
     models[2].setPitch(glm::radians(-90.0f));
@@ -692,6 +781,18 @@ void createModels() {
     models[2].translate();
     models[2].updateMatrix();
     models[2].animator = &astroboyAnimator;
+
+    for (usize i = 0; i < MODELS_COUNT; i++) {
+        if (models[i].shape->bonesPerVertex != 0) {
+            if (dualQuaternionSkinning)
+                models[i].animator->skinningMode = Animator::DualQuaternionSkinning;
+
+            animationBatch.add(&models[i]);
+        }
+    }
+
+    // poses for the first frame
+    animationBatch.animate(glfwGetTime());
 }
 
 /**
@@ -751,6 +852,21 @@ void initShadowCalculation() {
     glUseProgram(0);
 }
 
+/**
+ * Creating buffer for bone palettes, all skinning shaders read it from the same texture unit
+ */
+void initBonePalette() {
+    bonePalette = new BonePaletteBuffer();
+
+    colorShader->use();
+    colorShader->setInt(AlgineNames::ColorShader::Bones, BONES_TSID);
+    pointShadowShader->use();
+    pointShadowShader->setInt(AlgineNames::ShadowShader::Bones, BONES_TSID);
+    dirShadowShader->use();
+    dirShadowShader->setInt(AlgineNames::ShadowShader::Bones, BONES_TSID);
+    glUseProgram(0);
+}
+
 /**
  * Initialize Depth of field
  */
@@ -773,6 +889,9 @@ void recycleAll() {
     for (size_t i = 0; i < SHAPES_COUNT; i++)
         shapes[i]->recycle();
 
+    delete geometryHeap;
+    delete bonePalette;
+
     Framebuffer::destroy(displayFb, screenspaceFb, bloomSearchFb, pingpongFb[0], pingpongFb[1],
                          pingpongBlurBloomFb[0], pingpongBlurBloomFb[1],
                          pingpongBlurCoCFb[0], pingpongBlurCoCFb[1], cocFb);
@@ -815,20 +934,31 @@ void updateMatrices() {
  * Draws model in depth map<br>
  * if point light, leave mat empty, but if dir light - it must be light space matrix
  */
-void drawModelDM(const Model &model, ShaderProgram *program, const glm::mat4 &mat = glm::mat4(1.0f)) {
-    glBindVertexArray(model.shape->vaos[0]);
+// shapes from the same GeometryHeap pool share VAO, so redundant binds are skipped
+uint boundShapeVAO = 0;
 
-    if (model.shape->bonesPerVertex != 0) {
-        for (int i = 0; i < model.shape->bones.size(); i++) {
-            program->setMat4(program->getLocation(AlgineNames::ShadowShader::Bones) + i, model.shape->bones[i].finalTransformation);
-        }
+inline void bindShapeVAO(const uint vao) {
+    if (boundShapeVAO != vao) {
+        glBindVertexArray(vao);
+        boundShapeVAO = vao;
     }
+}
+
+void drawModelDM(const Model &model, ShaderProgram *program, const glm::mat4 &mat = glm::mat4(1.0f)) {
+    bindShapeVAO(model.shape->vaos[0]);
+
+    if (model.shape->bonesPerVertex != 0)
+        program->setInt(AlgineNames::ShadowShader::BoneOffset, model.paletteOffset);
 
     program->setInt(AlgineNames::ShadowShader::BoneAttribsPerVertex, (int)(model.shape->bonesPerVertex / 4 + (model.shape->bonesPerVertex % 4 == 0 ? 0 : 1)));
     program->setMat4(AlgineNames::ShadowShader::TransformationMatrix, mat * model.m_transform);
     
     for (size_t i = 0; i < model.shape->meshes.size(); i++) {
-        glDrawElements(GL_TRIANGLES, model.shape->meshes[i].count, GL_UNSIGNED_INT, reinterpret_cast<void*>(model.shape->meshes[i].start * sizeof(uint)));
+        const Mesh &mesh = model.shape->meshes[i];
+        program->setVec3(AlgineNames::ShadowShader::PositionOffset, mesh.positionOffset);
+        program->setVec3(AlgineNames::ShadowShader::PositionScale, mesh.positionScale);
+        glDrawElementsBaseVertex(GL_TRIANGLES, mesh.getLod(model.lod).count, mesh.indexType,
+                mesh.getIndicesOffset(model.lod), mesh.baseVertex);
     }
 }
 
@@ -840,16 +970,51 @@ if (tex != nullptr) \
     tex->use(slot); \
 else \
     texture2DAB(slot, 0);
+// visible meshlets draw lists, reused between draw calls
+std::vector<GLsizei> meshletsCounts;
+std::vector<const void*> meshletsOffsets;
+std::vector<GLint> meshletsBaseVertices;
+
+/**
+ * Draws only meshlets that are inside the frustum and not back-facing
+ * @param frustum frustum planes in model space
+ * @param cameraPos camera position in model space
+ */
+void drawMeshlets(const Shape &shape, const Mesh &mesh, const glm::vec4 *frustum, const glm::vec3 &cameraPos) {
+    meshletsCounts.clear();
+    meshletsOffsets.clear();
+    meshletsBaseVertices.clear();
+
+    for (uint i = mesh.meshletsStart; i < mesh.meshletsStart + mesh.meshletsCount; i++) {
+        const Meshlet &meshlet = shape.meshlets[i];
+
+        if (!meshlet.isInFrustum(frustum) || meshlet.isBackFacing(cameraPos))
+            continue;
+
+        meshletsCounts.push_back(meshlet.count);
+        meshletsOffsets.push_back(reinterpret_cast<const void*>(static_cast<usize>(meshlet.start) * mesh.getIndexSize() + mesh.indicesByteOffset));
+        meshletsBaseVertices.push_back(mesh.baseVertex);
+    }
+
+    if (!meshletsCounts.empty()) {
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, meshletsCounts.data(), mesh.indexType,
+                meshletsOffsets.data(), meshletsCounts.size(), meshletsBaseVertices.data());
+    }
+}
+
 void drawModel(const Model &model) {
-    glBindVertexArray(model.shape->vaos[1]);
+    bindShapeVAO(model.shape->vaos[1]);
+
+    // meshlets culling is done in model space
+    glm::vec4 frustum[6];
+    Meshlet::getFrustumPlanes(camera.getProjectionMatrix() * camera.getViewMatrix() * model.m_transform, frustum);
+    glm::vec3 cameraPos = glm::vec3(glm::inverse(model.m_transform) * glm::vec4(camera.getPos(), 1.0f));
     
-    if (model.shape->bonesPerVertex != 0) {
-        for (int i = 0; i < model.shape->bones.size(); i++) {
-            colorShader->setMat4(colorShader->getLocation(AlgineNames::ColorShader::Bones) + i, model.shape->bones[i].finalTransformation);
-        }
-    }
+    if (model.shape->bonesPerVertex != 0)
+        colorShader->setInt(AlgineNames::ColorShader::BoneOffset, model.paletteOffset);
 
     colorShader->setInt(AlgineNames::ColorShader::BoneAttribsPerVertex, model.shape->bonesPerVertex / 4 + (model.shape->bonesPerVertex % 4 == 0 ? 0 : 1));
+    colorShader->setBool(AlgineNames::ColorShader::OctahedralNormals, model.shape->vertexFormat.octahedral);
     modelMatrix = &model.m_transform;
 	updateMatrices();
     for (size_t i = 0; i < model.shape->meshes.size(); i++) {
@@ -860,12 +1025,27 @@ void drawModel(const Model &model) {
         useNotNull(model.shape->meshes[i].material.reflectionTexture, 4);
         useNotNull(model.shape->meshes[i].material.jitterTexture, 5);
 
+        const shared_ptr<Texture2D> &normalTexture = model.shape->meshes[i].material.normalTexture;
+        colorShader->setBool(AlgineNames::ColorShader::Material::IsNormalTexRG,
+                normalTexture != nullptr && normalTexture->format == Texture::BC5);
+
         colorShader->setFloat(AlgineNames::ColorShader::Material::AmbientStrength, model.shape->meshes[i].material.ambientStrength);
         colorShader->setFloat(AlgineNames::ColorShader::Material::DiffuseStrength, model.shape->meshes[i].material.diffuseStrength);
         colorShader->setFloat(AlgineNames::ColorShader::Material::SpecularStrength, model.shape->meshes[i].material.specularStrength);
         colorShader->setFloat(AlgineNames::ColorShader::Material::Shininess, model.shape->meshes[i].material.shininess);
 
-        glDrawElements(GL_TRIANGLES, model.shape->meshes[i].count, GL_UNSIGNED_INT, reinterpret_cast<void*>(model.shape->meshes[i].start * sizeof(uint)));
+        const Mesh &mesh = model.shape->meshes[i];
+        colorShader->setVec3(AlgineNames::ColorShader::PositionOffset, mesh.positionOffset);
+        colorShader->setVec3(AlgineNames::ColorShader::PositionScale, mesh.positionScale);
+
+        // meshlet bounds don't follow skinning
+        if (model.lod == 0 && mesh.meshletsCount != 0 && model.shape->bonesPerVertex == 0) {
+            drawMeshlets(*model.shape, mesh, frustum, cameraPos);
+            continue;
+        }
+
+        glDrawElementsBaseVertex(GL_TRIANGLES, mesh.getLod(model.lod).count, mesh.indexType,
+                mesh.getIndicesOffset(model.lod), mesh.baseVertex);
     }
 }
 
@@ -878,6 +1058,7 @@ void renderToDepthCubemap(const uint index) {
     lightDataSetter.setShadowShaderPos(pointLamps[index]);
 	lightDataSetter.setShadowShaderMatrices(pointLamps[index]);
 	glClear(GL_DEPTH_BUFFER_BIT);
+    boundShapeVAO = 0; // VAO binding could be changed by other renderers
 
 	// drawing models
     for (size_t i = 0; i < MODELS_COUNT; i++)
@@ -898,6 +1079,7 @@ void renderToDepthCubemap(const uint index) {
 void renderToDepthMap(uint index) {
 	dirLamps[index].begin();
 	glClear(GL_DEPTH_BUFFER_BIT);
+    boundShapeVAO = 0;
 
 	// drawing models
     for (size_t i = 0; i < MODELS_COUNT; i++)
@@ -932,6 +1114,7 @@ void render() {
 	sendLampsData();
 
     // drawing
+    boundShapeVAO = 0;
     for (size_t i = 0; i < MODELS_COUNT; i++)
         drawModel(models[i]);
 	for (size_t i = 0; i < pointLampsCount + dirLampsCount; i++)
@@ -983,10 +1166,24 @@ void render() {
 }
 
 void display() {
-    // animate
+    // poses evaluated during the previous frame become visible,
+    // the next ones are evaluated while this frame is rendered
+    animationBatch.finish();
+    animationBatch.begin(glfwGetTime());
+
+    // palettes are uploaded once and shared by the shadow & color passes
+    bonePalette->begin();
+
     for (usize i = 0; i < MODELS_COUNT; i++)
         if (models[i].shape->bonesPerVertex != 0)
-            models[i].animator->animate(glfwGetTime());
+            models[i].paletteOffset = bonePalette->add(models[i].palette);
+
+    bonePalette->end();
+    bonePalette->use(BONES_TSID);
+
+    // select levels of detail, shadow passes use the same levels
+    for (usize i = 0; i < MODELS_COUNT; i++)
+        models[i].updateLod(camera.getViewMatrix(), camera.getProjectionMatrix(), winHeight);
 
     // shadow rendering
     // point lights
@@ -1031,6 +1228,7 @@ int main() {
     initLamps();
     initShadowMaps();
     initShadowCalculation();
+    initBonePalette();
     initDOF();
     
     mouseEventListener.setCallback(mouse_callback);
@@ -1050,6 +1248,7 @@ int main() {
             previousTime = currentTime;
         }
 
+        GLUploadQueue::getDefault()->process();
         display();
         // Check if any events have been activiated (key pressed, mouse moved etc.) and call corresponding response functions
         glfwPollEvents();
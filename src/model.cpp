@@ -11,17 +11,52 @@
 #include <algine/texture.h>
 #include <algine/node.h>
 #include <algine/algine_renderer.h>
+#include <algine/ShapeCache.h>
+#include <algine/ThreadPool.h>
+#include <algine/MeshOptimizer.h>
+#include <algine/VertexQuantizer.h>
+#include <algine/TextureCompressor.h>
+#include <algine/MipmapGenerator.h>
+#include <algine/GeometryHeap.h>
+#include <algine/PackIOSystem.h>
 #include <tulz/Path>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <limits>
 
 using namespace tulz;
 using namespace std;
 
 namespace algine {
+template<typename T>
+inline usize getVectorSize(const vector<T> &v) {
+    return v.size() * sizeof(T);
+}
+
+// clear() doesn't free memory, so the vector is swapped with the empty one
+template<typename T>
+inline void releaseVector(vector<T> &v) {
+    vector<T>().swap(v);
+}
+
+usize Geometry::getSize() const {
+    return getVectorSize(vertices) + getVectorSize(normals) + getVectorSize(texCoords) +
+           getVectorSize(tangents) + getVectorSize(bitangents) + getVectorSize(boneWeights) +
+           getVectorSize(indices) + getVectorSize(boneIds);
+}
+
 void Shape::delBuffers() {
+    if (heap != nullptr) {
+        // VAOs are owned by the heap
+        heap->remove(*this);
+        return;
+    }
+
     glDeleteVertexArrays(vaos.size(), &vaos[0]);
 
     ArrayBuffer::destroy(buffers.vertices, buffers.normals, buffers.texCoords,
-            buffers.tangents, buffers.bitangents, buffers.boneWeights, buffers.boneIds);
+            buffers.tangents, buffers.bitangents, buffers.boneWeights, buffers.boneIds, buffers.interleaved);
     IndexBuffer::destroy(buffers.indices);
 }
 
@@ -33,35 +68,70 @@ void Shape::createVAO(
         int inTangent, int inBitangent,
         int inBoneWeights, int inBoneIds
     ) {
-    vaos.push_back(0); // allocate memory
-    glGenVertexArrays(1, &vaos[vaos.size() - 1]);
-    glBindVertexArray(vaos[vaos.size() - 1]);
-
-    // TODO: create class VertexArray (or VertexAttribArray). It must have (as minimum) enable() and setBuffer() (or setPointer?)
-    #define _pointer(location, count, buffer) if (buffer != nullptr && location != -1) { glEnableVertexAttribArray(location); pointer(location, count, buffer->m_id); }
-    #define _pointerui(location, count, buffer) if (buffer != nullptr && location != -1) { glEnableVertexAttribArray(location); pointerui(location, count, buffer->m_id); }
-    
-    _pointer(inPosition, 3, buffers.vertices)
-    _pointer(inNormal, 3, buffers.normals)
-    _pointer(inTangent, 3, buffers.tangents)
-    _pointer(inBitangent, 3, buffers.bitangents)
-    _pointer(inTexCoord, 2, buffers.texCoords)
+    AttribLocations locations;
+    locations.position = inPosition;
+    locations.texCoord = inTexCoord;
+    locations.normal = inNormal;
+    locations.tangent = inTangent;
+    locations.bitangent = inBitangent;
 
     if (bonesPerVertex != 0) {
-        _pointer(inBoneWeights, 4, buffers.boneWeights)
-        _pointerui(inBoneIds, 4, buffers.boneIds)
+        locations.boneWeights = inBoneWeights;
+        locations.boneIds = inBoneIds;
     }
 
-    #undef _pointer
-    #undef _pointerui
+    // shapes with the same vertex format share VAO
+    if (heap != nullptr) {
+        vaos.push_back(heap->getVAO(*this, locations));
+        return;
+    }
 
+    vaos.push_back(0); // allocate memory
+    glGenVertexArrays(1, &vaos[vaos.size() - 1]);
+    glBindVertexArray(vaos[vaos.size() - 1]);
+    setAttribPointers(vertexFormat, buffers, locations);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     buffers.indices->bind();
     glBindVertexArray(0);
 }
 
+void Shape::setAttribPointers(const VertexFormat &format, const Buffers &buffers, const AttribLocations &locations) {
+    // TODO: create class VertexArray (or VertexAttribArray). It must have (as minimum) enable() and setBuffer() (or setPointer?)
+    // if interleaved buffer exists, all attributes are stored in it
+    #define _buffer(attrib) (buffers.interleaved != nullptr ? buffers.interleaved : buffers.attrib)
+    #define _offset(attrib) reinterpret_cast<const void*>(static_cast<usize>(format.attrib.offset))
+    #define _stride(attrib) (format.stride != 0 ? format.stride : format.attrib.size)
+    #define _pointer(location, attrib) if (format.attrib.count != 0 && location != -1) { glEnableVertexAttribArray(location); pointer(location, format.attrib.count, _buffer(attrib)->m_id, format.attrib.type, format.attrib.normalized, _stride(attrib), _offset(attrib)); }
+    #define _pointerui(location, attrib) if (format.attrib.count != 0 && location != -1) { glEnableVertexAttribArray(location); pointerui(location, format.attrib.count, _buffer(attrib)->m_id, format.attrib.type, _stride(attrib), _offset(attrib)); }
+
+    _pointer(locations.position, vertices)
+    _pointer(locations.normal, normals)
+    _pointer(locations.tangent, tangents)
+    _pointer(locations.bitangent, bitangents)
+    _pointer(locations.texCoord, texCoords)
+    _pointer(locations.boneWeights, boneWeights)
+    _pointerui(locations.boneIds, boneIds)
+
+    #undef _buffer
+    #undef _offset
+    #undef _stride
+    #undef _pointer
+    #undef _pointerui
+}
+
 void Shape::setNodeTransform(const std::string &nodeName, const glm::mat4 &transformation) {
-    rootNode.getNode(nodeName)->transformation = transformation;
+    // skeleton isn't built yet
+    if (skeleton.getNodesCount() == 0) {
+        rootNode.getNode(nodeName)->transformation = transformation;
+        return;
+    }
+
+    int index = skeleton.getNodeIndex(nodeName);
+
+    if (index != -1) {
+        skeleton.transformations[index] = transformation;
+        skeleton.nodes[index]->transformation = transformation;
+    }
 }
 
 void Shape::recycle() {
@@ -76,126 +146,292 @@ void Model::updateMatrix() {
     m_transform = m_translation * m_rotation * m_scaling;
 }
 
-inline int getBoneIndex(const Shape *shape, const std::string &name) {
-    for (usize i = 0; i < shape->bones.size(); i++)
-        if (shape->bones[i].name == name)
-            return i;
+void Model::updateLod(const glm::mat4 &view, const glm::mat4 &projection, const float viewportHeight, const float maxPixelError) {
+    lod = 0;
 
-    return -1;
-}
+    if (shape->lodErrors.size() < 2)
+        return;
 
-void ShapeLoader::loadBones(const aiMesh *aimesh) {
-    std::vector<BoneInfo> binfos; // bone infos
-    binfos.reserve(aimesh->mNumVertices); // allocating space
+    float scale = std::max(glm::length(glm::vec3(m_transform[0])),
+            std::max(glm::length(glm::vec3(m_transform[1])), glm::length(glm::vec3(m_transform[2]))));
+    glm::vec4 center = view * m_transform * glm::vec4(shape->boundingCenter, 1.0f);
 
-    // filling array
-    for (size_t i = 0; i < aimesh->mNumVertices; i++)
-        binfos.emplace_back(m_shape->bonesPerVertex);
+    // distance to the nearest point of the bounding sphere
+    float distance = -center.z - shape->boundingRadius * scale;
 
-    // loading bone data
-    for (usize i = 0; i < aimesh->mNumBones; i++) {
-        aiBone *bone = aimesh->mBones[i];
-        std::string boneName(bone->mName.data);
-        int boneIndex = getBoneIndex(m_shape, boneName);
+    if (distance <= 0)
+        return;
 
-        if (boneIndex == -1) {
-            boneIndex = m_shape->bones.size();
-            m_shape->bones.emplace_back(boneName, getMat4(bone->mOffsetMatrix));
-        }
+    // pixels per model space unit
+    float pixelsPerUnit = scale * projection[1][1] * viewportHeight * 0.5f / distance;
 
-        for (usize j = 0; j < bone->mNumWeights; j++) {
-            aiVertexWeight *vertexWeight = &(bone->mWeights[j]);
-            binfos[vertexWeight->mVertexId].add(boneIndex, vertexWeight->mWeight);
+    for (auto level = static_cast<uint>(shape->lodErrors.size() - 1); level > 0; level--) {
+        if (shape->lodErrors[level] * pixelsPerUnit <= maxPixelError) {
+            lod = level;
+            break;
         }
     }
+}
+
+void Model::animate(const float timeInSeconds) {
+    if (animator != nullptr)
+        animator->animate(timeInSeconds, palette);
+}
+
+void Model::animateBack(const float timeInSeconds) {
+    if (animator != nullptr)
+        animator->animate(timeInSeconds, backPalette);
+}
+
+void Model::swapPalettes() {
+    palette.swap(backPalette);
+}
+
+uint ShapeLoader::registerBone(const aiBone *bone) {
+    string boneName(bone->mName.data);
+    auto boneIndex = m_bonesIndices.find(boneName);
+
+    if (boneIndex != m_bonesIndices.end())
+        return boneIndex->second;
+
+    uint index = m_shape->bones.size();
+    m_shape->bones.emplace_back(boneName, getMat4(bone->mOffsetMatrix));
+    m_bonesIndices[boneName] = index;
+
+    return index;
+}
+
+/**
+ * Writes the `bonesPerVertex` strongest influences of each vertex of `aimesh` to
+ * preallocated `geometry` bone streams starting from `dstVertex`, weights are renormalized.
+ * Slots of each vertex are sorted by weight (descending), unused slots have zero weight
+ * @param boneIndices shape bone index of each `aimesh` bone
+ */
+inline void gatherBoneWeights(Geometry &geometry, const aiMesh *aimesh, const usize dstVertex,
+        const uint *boneIndices, const uint bonesPerVertex)
+{
+    uint *const ids = &geometry.boneIds[dstVertex * bonesPerVertex];
+    float *const weights = &geometry.boneWeights[dstVertex * bonesPerVertex];
+
+    for (uint i = 0; i < aimesh->mNumBones; i++) {
+        const aiBone *bone = aimesh->mBones[i];
+
+        for (uint j = 0; j < bone->mNumWeights; j++) {
+            const aiVertexWeight &vertexWeight = bone->mWeights[j];
+            uint *vertexIds = ids + vertexWeight.mVertexId * bonesPerVertex;
+            float *vertexWeights = weights + vertexWeight.mVertexId * bonesPerVertex;
+
+            // insertion into the sorted slots, the weakest influence is dropped
+            uint slot = bonesPerVertex;
+            while (slot > 0 && vertexWeights[slot - 1] < vertexWeight.mWeight)
+                slot--;
 
-    // converting to a suitable view
-    for (size_t i = 0; i < binfos.size(); i++) {
-        for (size_t j = 0; j < binfos[i].size; j++) {
-            m_shape->geometry.boneIds.push_back(binfos[i].ids[j]);
-            m_shape->geometry.boneWeights.push_back(binfos[i].weights[j]);
+            if (slot == bonesPerVertex)
+                continue;
+
+            for (uint k = bonesPerVertex - 1; k > slot; k--) {
+                vertexIds[k] = vertexIds[k - 1];
+                vertexWeights[k] = vertexWeights[k - 1];
+            }
+
+            vertexIds[slot] = boneIndices[i];
+            vertexWeights[slot] = vertexWeight.mWeight;
         }
     }
+
+    for (uint i = 0; i < aimesh->mNumVertices; i++) {
+        float *vertexWeights = weights + i * bonesPerVertex;
+        float sum = 0;
+
+        for (uint k = 0; k < bonesPerVertex; k++)
+            sum += vertexWeights[k];
+
+        if (sum > 0)
+            for (uint k = 0; k < bonesPerVertex; k++)
+                vertexWeights[k] /= sum;
+    }
 }
 
-void ShapeLoader::processNode(const aiNode *node, const aiScene *scene) {
+void ShapeLoader::processNode(const aiNode *node, const aiScene *scene, vector<const aiMesh*> &aimeshes) {
     // обработать все полигональные сетки в узле (если есть)
-    for (size_t i = 0; i < node->mNumMeshes; i++) {
-        aiMesh *mesh = scene->mMeshes[node->mMeshes[i]];
-        processMesh(mesh, scene);
-        if (m_shape->bonesPerVertex != 0)
-            loadBones(mesh);
-    }
+    for (size_t i = 0; i < node->mNumMeshes; i++)
+        aimeshes.push_back(scene->mMeshes[node->mMeshes[i]]);
 
     // выполнить ту же обработку и для каждого потомка узла
     for (size_t i = 0; i < node->mNumChildren; i++) {
-        processNode(node->mChildren[i], scene);
+        processNode(node->mChildren[i], scene, aimeshes);
     }
 }
 
-inline void mergeTexturePath(std::string &saveTo, AMTLLoader::MaterialObject &amtlMaterialObject, const uint key) {
-    if (amtlMaterialObject.textures.find(key) != amtlMaterialObject.textures.end() &&
-        !amtlMaterialObject.textures[key].path.empty())
-    {
-        saveTo = amtlMaterialObject.textures[key].path;
+// big meshes are split to chunks, so they are imported in parallel too
+constexpr uint importChunkSize = 65536;
+
+static_assert(sizeof(aiVector3D) == sizeof(float) * 3, "aiVector3D must consist of 3 floats");
+
+inline void copyVec3(vector<float> &dst, const aiVector3D *src, const usize dstVertex, const uint count) {
+    memcpy(&dst[dstVertex * 3], src, count * sizeof(aiVector3D));
+}
+
+// copies vertices [first, first + count) of `aimesh` to `geometry` starting from `dstVertex`
+inline void importVertices(Geometry &geometry, const aiMesh *aimesh, const usize dstVertex, const uint first, const uint count) {
+    copyVec3(geometry.vertices, aimesh->mVertices + first, dstVertex, count);
+
+    // streams, which are absent in the mesh, stay filled with zeros
+    if (aimesh->HasNormals() && !geometry.normals.empty())
+        copyVec3(geometry.normals, aimesh->mNormals + first, dstVertex, count);
+
+    if (aimesh->HasTangentsAndBitangents() && !geometry.tangents.empty()) {
+        copyVec3(geometry.tangents, aimesh->mTangents + first, dstVertex, count);
+        copyVec3(geometry.bitangents, aimesh->mBitangents + first, dstVertex, count);
+    }
+
+    if (aimesh->HasTextureCoords(0) && !geometry.texCoords.empty()) {
+        const aiVector3D *texCoords = aimesh->mTextureCoords[0] + first;
+        float *dst = &geometry.texCoords[dstVertex * 2];
+
+        for (uint i = 0; i < count; i++) {
+            dst[i * 2] = texCoords[i].x;
+            dst[i * 2 + 1] = texCoords[i].y;
+        }
     }
 }
 
-void ShapeLoader::processMesh(const aiMesh *aimesh, const aiScene *scene) {
-    Mesh mesh;
-    mesh.start = m_shape->geometry.indices.size();
-    uint verticesAtBeggining = m_shape->geometry.vertices.size() / 3;
-
-    // allocating space for vertices, normals, texCoords, tangents and bitangents
-    m_shape->geometry.vertices.reserve(aimesh->mNumVertices * 3);
-    if (aimesh->HasNormals())
-        m_shape->geometry.normals.reserve(aimesh->mNumVertices * 3);
-    if (aimesh->HasTextureCoords(0))
-        m_shape->geometry.texCoords.reserve(aimesh->mNumVertices * 2);
-    if (aimesh->HasTangentsAndBitangents()) {
-        m_shape->geometry.tangents.reserve(aimesh->mNumVertices * 3);
-        m_shape->geometry.bitangents.reserve(aimesh->mNumVertices * 3);
-    }
-
-    for (size_t i = 0; i < aimesh->mNumVertices; i++) {
-        // vertices
-        m_shape->geometry.vertices.push_back(aimesh->mVertices[i].x);
-        m_shape->geometry.vertices.push_back(aimesh->mVertices[i].y);
-        m_shape->geometry.vertices.push_back(aimesh->mVertices[i].z);
-
-        // normals
-        if (aimesh->HasNormals()) {
-            m_shape->geometry.normals.push_back(aimesh->mNormals[i].x);
-            m_shape->geometry.normals.push_back(aimesh->mNormals[i].y);
-            m_shape->geometry.normals.push_back(aimesh->mNormals[i].z);
+void ShapeLoader::processMeshes(const vector<const aiMesh*> &aimeshes, const aiScene *scene) {
+    Geometry &geometry = m_shape->geometry;
+
+    // faces chunk to import: indices are written starting from `indexStart`
+    struct FacesChunk {
+        const aiMesh *aimesh;
+        uint firstFace, facesCount;
+        usize indexStart;
+        uint baseVertex;
+    };
+
+    vector<usize> vertexStarts(aimeshes.size());
+    vector<FacesChunk> facesChunks;
+    usize verticesCount = geometry.vertices.size() / 3, indicesCount = geometry.indices.size();
+    bool hasNormals = false, hasTexCoords = false, hasTangents = false;
+
+    // phase 1: vertex & index offsets (prefix sum) and materials
+    for (usize i = 0; i < aimeshes.size(); i++) {
+        const aiMesh *aimesh = aimeshes[i];
+        usize meshStart = indicesCount;
+
+        for (uint face = 0; face < aimesh->mNumFaces; face += importChunkSize) {
+            uint facesCount = std::min(importChunkSize, aimesh->mNumFaces - face);
+            facesChunks.push_back({aimesh, face, facesCount, indicesCount, static_cast<uint>(verticesCount)});
+
+            for (uint j = face; j < face + facesCount; j++) {
+                indicesCount += aimesh->mFaces[j].mNumIndices;
+            }
         }
 
-        // texCoords
-        if (aimesh->HasTextureCoords(0)) {
-            m_shape->geometry.texCoords.push_back(aimesh->mTextureCoords[0][i].x);
-            m_shape->geometry.texCoords.push_back(aimesh->mTextureCoords[0][i].y);
+        processMesh(aimesh, scene, meshStart, indicesCount - meshStart);
+
+        vertexStarts[i] = verticesCount;
+        verticesCount += aimesh->mNumVertices;
+
+        hasNormals |= aimesh->HasNormals();
+        hasTexCoords |= aimesh->HasTextureCoords(0);
+        hasTangents |= aimesh->HasTangentsAndBitangents();
+    }
+
+    // bones are registered in the meshes order
+    uint bonesPerVertex = m_shape->bonesPerVertex;
+    vector<vector<uint>> boneIndices(aimeshes.size());
+
+    if (bonesPerVertex != 0) {
+        for (usize i = 0; i < aimeshes.size(); i++) {
+            boneIndices[i].resize(aimeshes[i]->mNumBones);
+
+            for (uint j = 0; j < aimeshes[i]->mNumBones; j++) {
+                boneIndices[i][j] = registerBone(aimeshes[i]->mBones[j]);
+            }
         }
 
-        // tangents and bitangents
-        if (aimesh->HasTangentsAndBitangents()) {
-            m_shape->geometry.tangents.push_back(aimesh->mTangents[i].x);
-            m_shape->geometry.tangents.push_back(aimesh->mTangents[i].y);
-            m_shape->geometry.tangents.push_back(aimesh->mTangents[i].z);
+        m_bonesIndices.clear();
+    }
+
+    // allocating space once
+    geometry.vertices.resize(verticesCount * 3);
+    geometry.indices.resize(indicesCount);
+
+    if (hasNormals)
+        geometry.normals.resize(verticesCount * 3);
+
+    if (hasTexCoords)
+        geometry.texCoords.resize(verticesCount * 2);
+
+    if (hasTangents) {
+        geometry.tangents.resize(verticesCount * 3);
+        geometry.bitangents.resize(verticesCount * 3);
+    }
+
+    if (bonesPerVertex != 0) {
+        geometry.boneIds.resize(verticesCount * bonesPerVertex);
+        geometry.boneWeights.resize(verticesCount * bonesPerVertex);
+    }
+
+    // phase 2: filling disjoint slices of geometry on the worker threads
+    ThreadPool *pool = ThreadPool::getDefault();
+    vector<future<void>> tasks;
 
-            m_shape->geometry.bitangents.push_back(aimesh->mBitangents[i].x);
-            m_shape->geometry.bitangents.push_back(aimesh->mBitangents[i].y);
-            m_shape->geometry.bitangents.push_back(aimesh->mBitangents[i].z);
+    for (usize i = 0; i < aimeshes.size(); i++) {
+        const aiMesh *aimesh = aimeshes[i];
+
+        for (uint first = 0; first < aimesh->mNumVertices; first += importChunkSize) {
+            uint count = std::min(importChunkSize, aimesh->mNumVertices - first);
+            usize dstVertex = vertexStarts[i] + first;
+
+            tasks.push_back(pool->submit([&geometry, aimesh, dstVertex, first, count]() {
+                importVertices(geometry, aimesh, dstVertex, first, count);
+            }));
         }
     }
 
-    // faces
-    for (size_t i = 0; i < aimesh->mNumFaces; i++) {
-        for (size_t j = 0; j < aimesh->mFaces[i].mNumIndices; j++) {
-            m_shape->geometry.indices.push_back(aimesh->mFaces[i].mIndices[j] + verticesAtBeggining);
+    if (bonesPerVertex != 0) {
+        for (usize i = 0; i < aimeshes.size(); i++) {
+            const aiMesh *aimesh = aimeshes[i];
+            const uint *indices = boneIndices[i].data();
+            usize dstVertex = vertexStarts[i];
+
+            tasks.push_back(pool->submit([&geometry, aimesh, dstVertex, indices, bonesPerVertex]() {
+                gatherBoneWeights(geometry, aimesh, dstVertex, indices, bonesPerVertex);
+            }));
         }
     }
 
-    mesh.count = m_shape->geometry.indices.size() - mesh.start;
+    for (const FacesChunk &chunk : facesChunks) {
+        tasks.push_back(pool->submit([&geometry, chunk]() {
+            uint *indices = &geometry.indices[chunk.indexStart];
+
+            for (uint face = chunk.firstFace; face < chunk.firstFace + chunk.facesCount; face++) {
+                const aiFace &aiface = chunk.aimesh->mFaces[face];
+
+                for (uint j = 0; j < aiface.mNumIndices; j++) {
+                    *indices++ = aiface.mIndices[j] + chunk.baseVertex;
+                }
+            }
+        }));
+    }
+
+    // prepare itself can be executed by the pool
+    for (auto &task : tasks)
+        pool->wait(task);
+}
+
+inline void mergeTexturePath(std::string &saveTo, AMTLLoader::MaterialObject &amtlMaterialObject, const uint key) {
+    if (amtlMaterialObject.textures.find(key) != amtlMaterialObject.textures.end() &&
+        !amtlMaterialObject.textures[key].path.empty())
+    {
+        saveTo = amtlMaterialObject.textures[key].path;
+    }
+}
+
+void ShapeLoader::processMesh(const aiMesh *aimesh, const aiScene *scene, const usize start, const usize count) {
+    Mesh mesh;
+    mesh.start = start;
+    mesh.count = count;
 
     // load classic material & merge with AMTL
     aiString tmp_str;
@@ -258,10 +494,107 @@ void ShapeLoader::processMesh(const aiMesh *aimesh, const aiScene *scene) {
 }
 
 #define textureTypesCount 6
-void ShapeLoader::loadTextures() {
+
+// image processing is chosen by texture type
+enum ImageUsage {
+    ColorImage, // sRGB color: gamma correct mipmaps; BC1, or BC3 if image has alpha
+    DataImage, // linear data (specular, reflection): BC1 or BC3
+    NormalImage, // tangent space normals: renormalized mipmaps; BC5
+    NoiseImage // jitter noise: box filtered mipmaps, never compressed, block compression would break it
+};
+
+struct ImageKey {
+    string path;
+    uint usage;
+    bool compress;
+
+    bool operator==(const ImageKey &other) const {
+        return path == other.path && usage == other.usage && compress == other.compress;
+    }
+};
+
+inline uint getImageUsage(const uint texIndex) {
+    switch (texIndex) {
+        case AMTLLoader::AmbientTexture:
+        case AMTLLoader::DiffuseTexture:
+            return ColorImage;
+        case AMTLLoader::NormalTexture:
+            return NormalImage;
+        case AMTLLoader::JitterTexture:
+            return NoiseImage;
+        default:
+            return DataImage;
+    }
+}
+
+inline string getCompressedImagePath(const string &cacheDir, const ImageKey &key) {
+    if (cacheDir.empty())
+        return string();
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx_%u.atc", static_cast<unsigned long long>(hash<string>()(key.path)), key.usage);
+
+    return Path::join(cacheDir, name);
+}
+
+// decodes image from file or `pack` (if not null), generates mip chain and compresses it if needed
+inline void decodeImage(const ImageKey &key, const string &cacheDir, const AssetPack *pack, Image &image,
+        vector<MipmapGenerator::Level> &mipmaps, CompressedImage &compressedImage)
+{
+    string cachePath;
+
+    // cached image is valid while its source file (or the whole pack) is not changed
+    const string &sourcePath = pack != nullptr ? pack->getPath() : key.path;
+
+    if (key.compress) {
+        cachePath = getCompressedImagePath(cacheDir, key);
+
+        if (!cachePath.empty() && compressedImage.load(cachePath, sourcePath))
+            return;
+    }
+
+    if (!(pack != nullptr ? image.fromPack(*pack, key.path) : image.fromFile(key.path)))
+        return;
+
+    uint filter = key.usage == NoiseImage ? MipmapGenerator::Box : MipmapGenerator::Kaiser;
+    uint flags = 0;
+
+    if (key.usage == ColorImage)
+        flags = MipmapGenerator::GammaCorrect;
+    else if (key.usage == NormalImage)
+        flags = MipmapGenerator::NormalMap;
+
+    if (!key.compress) {
+        mipmaps = MipmapGenerator::generate(image.data, image.width, image.height, image.channels, filter, flags);
+        return;
+    }
+
+    uint format = Texture::BC5;
+
+    if (key.usage != NormalImage)
+        format = TextureCompressor::hasAlpha(image) ? Texture::BC3 : Texture::BC1;
+
+    if (TextureCompressor::compress(image, format, compressedImage, filter, flags)) {
+        image.free();
+
+        if (!cachePath.empty())
+            compressedImage.save(cachePath, sourcePath);
+    }
+}
+
+void ShapeLoader::prepareTextures() {
     if (m_texturesPath.empty())
         m_texturesPath = tulz::Path(m_modelPath).getParentDirectory();
 
+    vector<PendingTexture> &pendingTextures = m_pendingTextures;
+    vector<ImageKey> imageKeys; // unique images that must be decoded
+
+    // BC1 & BC3 require S3TC extension, BC5 (RGTC) is core since OpenGL 3.0
+    bool compress = hasParam(CompressTextures);
+    bool colorCompression = compress && GLEW_EXT_texture_compression_s3tc;
+
+    pendingTextures.clear();
+
     for (size_t i = 0; i < m_shape->meshes.size(); i++) {
         Material &material = m_shape->meshes[i].material;
         MaterialTexPaths &texPaths = m_materialTexPaths[i];
@@ -303,36 +636,125 @@ void ShapeLoader::loadTextures() {
                     }
                 }
 
-                // loading texture
-                vector<LoadedTexture> *loadedTextures = nullptr;
-                switch (sharedLevel) {
-                    case AMTLLoader::Shared:
-                        loadedTextures = &m_globalLoadedTextures;
-                        break;
-                    case AMTLLoader::ModelShared:
-                        loadedTextures = &m_modelLoadedTextures;
-                        break;
-                    default:
-                        break;
+                // searching in already loaded textures
+                TextureCache::Key key {absolutePath, params};
+                shared_ptr<Texture2D> loadedTexture;
+
+                if (sharedLevel == AMTLLoader::Shared) {
+                    loadedTexture = TextureCache::getDefault()->get(key);
+                } else if (sharedLevel == AMTLLoader::ModelShared) {
+                    auto modelTexture = m_modelLoadedTextures.find(key);
+                    if (modelTexture != m_modelLoadedTextures.end())
+                        loadedTexture = modelTexture->second;
                 }
 
-                int index = getLoadedTextureIndex(loadedTextures, absolutePath, params);
-                if (index != -1) {
-                    currentTexture = loadedTextures->operator[](index).texture; // texture already loaded
-                } else {
-                    shared_ptr<Texture2D> texture2D = make_shared<Texture2D>();
-                    texture2D->bind();
-                    texture2D->fromFile(absolutePath);
-                    texture2D->setParams(params);
-                    texture2D->unbind();
-                    currentTexture = texture2D;
-
-                    if (sharedLevel != AMTLLoader::Unique)
-                        loadedTextures->emplace_back(absolutePath, texture2D, params);
+                if (loadedTexture != nullptr) {
+                    currentTexture = loadedTexture; // texture already loaded
+                    continue;
+                }
+
+                // searching in textures requested by previous meshes
+                PendingTexture *pendingTexture = nullptr;
+
+                if (sharedLevel != AMTLLoader::Unique) {
+                    for (PendingTexture &pending : pendingTextures) {
+                        if (pending.sharedLevel == sharedLevel && pending.path == absolutePath && pending.params == params) {
+                            pendingTexture = &pending;
+                            break;
+                        }
+                    }
+                }
+
+                if (pendingTexture == nullptr) {
+                    uint usage = getImageUsage(texIndex);
+                    bool compressImage = usage == NormalImage ? compress : colorCompression && usage != NoiseImage;
+
+                    // the same image with different params is decoded only once
+                    ImageKey imageKey {absolutePath, usage, compressImage};
+                    auto image = find(imageKeys.begin(), imageKeys.end(), imageKey);
+                    usize imageIndex = image - imageKeys.begin();
+
+                    if (image == imageKeys.end())
+                        imageKeys.push_back(imageKey);
+
+                    pendingTextures.push_back({absolutePath, params, sharedLevel, imageIndex, {}});
+                    pendingTexture = &pendingTextures.back();
                 }
+
+                pendingTexture->destinations.push_back(&currentTexture);
             }
         }
     }
+
+    // decoding images on the worker threads
+    ThreadPool *pool = ThreadPool::getDefault();
+    vector<Image> &images = m_images;
+    vector<vector<MipmapGenerator::Level>> &mipmaps = m_mipmaps;
+    vector<CompressedImage> &compressedImages = m_compressedImages;
+    const string &cacheDir = m_texturesCachePath;
+    const AssetPack *pack = m_assetPack;
+    vector<future<void>> decodeTasks;
+
+    images.clear();
+    images.resize(imageKeys.size());
+    mipmaps.clear();
+    mipmaps.resize(imageKeys.size());
+    compressedImages.clear();
+    compressedImages.resize(imageKeys.size());
+    decodeTasks.reserve(imageKeys.size());
+
+    for (usize i = 0; i < imageKeys.size(); i++) {
+        decodeTasks.push_back(pool->submit([&images, &mipmaps, &compressedImages, &imageKeys, &cacheDir, pack, i]() {
+            decodeImage(imageKeys[i], cacheDir, pack, images[i], mipmaps[i], compressedImages[i]);
+        }));
+    }
+
+    // prepareTextures itself can be executed by the pool
+    for (auto &task : decodeTasks)
+        pool->wait(task);
+}
+
+void ShapeLoader::uploadTexture(const PendingTexture &pendingTexture) {
+    LoadStats::Scope scope(m_loadStats, LoadStats::TexturesUpload);
+    TextureCache *cache = TextureCache::getDefault();
+    TextureCache::Key key {pendingTexture.path, pendingTexture.params};
+    shared_ptr<Texture2D> texture2D;
+
+    // the same texture can be uploaded by the other loader while this one was decoding
+    if (pendingTexture.sharedLevel == AMTLLoader::Shared)
+        texture2D = cache->get(key);
+
+    if (texture2D == nullptr) {
+        const Image &image = m_images[pendingTexture.imageIndex];
+        const CompressedImage &compressedImage = m_compressedImages[pendingTexture.imageIndex];
+
+        bool decoded = !compressedImage.levels.empty() || image.data;
+
+        texture2D = make_shared<Texture2D>();
+        texture2D->bind();
+        if (!compressedImage.levels.empty())
+            texture2D->fromCompressedImage(compressedImage);
+        else if (image.data)
+            texture2D->fromImage(image, m_mipmaps[pendingTexture.imageIndex]);
+        texture2D->setParams(pendingTexture.params);
+        texture2D->unbind();
+
+        // decoding error is already reported; empty texture isn't shared,
+        // so the next loads will try to decode the image again
+        if (decoded && pendingTexture.sharedLevel == AMTLLoader::Shared) {
+            bool mipmaps = !m_mipmaps[pendingTexture.imageIndex].empty();
+            usize size = compressedImage.levels.empty() ?
+                    TextureCache::getTextureSize(image.width, image.height, texture2D->format, mipmaps) :
+                    compressedImage.getSize();
+
+            texture2D = cache->add(key, texture2D, size);
+        } else if (decoded && pendingTexture.sharedLevel == AMTLLoader::ModelShared) {
+            m_modelLoadedTextures[key] = texture2D;
+        }
+    }
+
+    for (shared_ptr<Texture2D> *destination : pendingTexture.destinations)
+        *destination = texture2D;
 }
 
 template<typename BufferType, typename DataType>
@@ -348,42 +770,309 @@ inline BufferType* createBuffer(const std::vector<DataType> &data) {
     return nullptr;
 }
 
-void ShapeLoader::genBuffers() {
-    m_shape->buffers.vertices = createBuffer<ArrayBuffer>(m_shape->geometry.vertices);
-    m_shape->buffers.normals = createBuffer<ArrayBuffer>(m_shape->geometry.normals);
-    m_shape->buffers.texCoords = createBuffer<ArrayBuffer>(m_shape->geometry.texCoords);
-    m_shape->buffers.tangents = createBuffer<ArrayBuffer>(m_shape->geometry.tangents);
-    m_shape->buffers.bitangents = createBuffer<ArrayBuffer>(m_shape->geometry.bitangents);
-    m_shape->buffers.boneWeights = createBuffer<ArrayBuffer>(m_shape->geometry.boneWeights);
-    m_shape->buffers.boneIds = createBuffer<ArrayBuffer>(m_shape->geometry.boneIds);
+template<typename T>
+inline vector<ubyte> toBytes(const vector<T> &src) {
+    vector<ubyte> bytes(src.size() * sizeof(T));
+    memcpy(bytes.data(), src.data(), bytes.size());
+    return bytes;
+}
+
+void ShapeLoader::uploadBuffer(const BufferData &bufferData) {
+    LoadStats::Scope scope(m_loadStats, LoadStats::BuffersUpload);
+    // only interleaved vertices can be suballocated
+    if (m_geometryHeap != nullptr && m_shape->vertexFormat.stride != 0) {
+        if (bufferData.arrayBuffer != nullptr) {
+            m_geometryHeap->addVertices(*m_shape, bufferData.data);
+        } else {
+            m_geometryHeap->addIndices(*m_shape, bufferData.data);
+        }
+
+        return;
+    }
 
-    m_shape->buffers.indices = createBuffer<IndexBuffer>(m_shape->geometry.indices);
+    if (bufferData.arrayBuffer != nullptr) {
+        *bufferData.arrayBuffer = createBuffer<ArrayBuffer>(bufferData.data);
+    } else {
+        *bufferData.indexBuffer = createBuffer<IndexBuffer>(bufferData.data);
+    }
 }
 
-ShapeLoader::LoadedTexture::LoadedTexture(
-        const string &path, const shared_ptr<Texture2D> &texture,
-        const map<uint, uint> &params)
+// vertex attribute data prepared for uploading
+struct AttribStream {
+    vector<ubyte> data;
+    Shape::VertexAttribFormat *format;
+    ArrayBuffer **buffer; // used if buffers are not interleaved
+
+    template<typename T>
+    void set(const vector<T> &src, const uint count, const uint type, const bool normalized, const uint size) {
+        data = toBytes(src);
+        setFormat(count, type, normalized, size);
+    }
+
+    void setFormat(const uint count, const uint type, const bool normalized, const uint size) {
+        format->count = count;
+        format->type = type;
+        format->normalized = normalized;
+        format->size = size;
+    }
+};
+
+/**
+ * Packs the first `count` influences of each vertex, padded to 4 components:
+ * ids as `T`, weights as normalized `T`. Weights are renormalized and the rounding
+ * error is added to the strongest influence (slots are sorted), so their sum is exactly 1
+ */
+template<typename T>
+inline void quantizeBones(AttribStream &weightsStream, AttribStream &idsStream, const Geometry &geometry,
+        const uint bonesPerVertex, const uint count, const uint type)
 {
-    this->path = path;
-    this->texture = texture;
-    this->params = params;
+    constexpr int maxValue = numeric_limits<T>::max();
+    usize verticesCount = geometry.boneWeights.size() / bonesPerVertex;
+    vector<T> weights(verticesCount * 4, 0), ids(verticesCount * 4, 0);
+
+    for (usize i = 0; i < verticesCount; i++) {
+        const float *srcWeights = &geometry.boneWeights[i * bonesPerVertex];
+        const uint *srcIds = &geometry.boneIds[i * bonesPerVertex];
+        float sum = 0;
+
+        for (uint j = 0; j < count; j++)
+            sum += srcWeights[j];
+
+        if (sum == 0)
+            continue;
+
+        int remainder = maxValue;
+
+        for (uint j = 0; j < count; j++) {
+            auto value = static_cast<T>(srcWeights[j] / sum * maxValue + 0.5f);
+            weights[i * 4 + j] = value;
+            ids[i * 4 + j] = static_cast<T>(srcIds[j]);
+            remainder -= value;
+        }
+
+        weights[i * 4] = static_cast<T>(weights[i * 4] + remainder);
+    }
+
+    // all 4 components are declared: padding is zero, but missing
+    // components would be filled by GL with w = 1, a stray full weight bone
+    weightsStream.set(weights, 4, type, true, 4 * sizeof(T));
+    idsStream.set(ids, 4, type, false, 4 * sizeof(T));
 }
 
-// using vector instead of map since the same texture may have different params
-vector<ShapeLoader::LoadedTexture> ShapeLoader::m_globalLoadedTextures;
+inline void quantizeOctahedral(AttribStream &stream, const vector<float> &src) {
+    vector<int16> data(src.size() / 3 * 2);
 
-int ShapeLoader::getLoadedTextureIndex(
-        const vector<LoadedTexture> *const loadedTextures, const string &path,
-        const map<uint, uint> &params)
-{
-    if (!loadedTextures)
-        return -1;
+    for (usize i = 0; i < src.size() / 3; i++)
+        VertexQuantizer::toOctahedral(&src[i * 3], &data[i * 2]);
+
+    stream.set(data, 2, GL_SHORT, true, 2 * sizeof(int16));
+}
+
+// positions are normalized to the bounding box of each mesh
+inline void quantizePositions(AttribStream &stream, Shape *shape) {
+    const vector<float> &vertices = shape->geometry.vertices;
+
+    // 4th component is padding for 4-byte alignment
+    vector<uint16> data(vertices.size() / 3 * 4, 0);
+
+    for (Mesh &mesh : shape->meshes) {
+        if (mesh.count == 0)
+            continue;
+
+        auto begin = shape->geometry.indices.begin() + mesh.start;
+        auto range = minmax_element(begin, begin + mesh.count);
+        uint first = *range.first, last = *range.second;
+
+        // mesh range bounding box
+        glm::vec3 min(vertices[first * 3], vertices[first * 3 + 1], vertices[first * 3 + 2]), max = min;
+
+        for (uint i = first; i <= last; i++) {
+            glm::vec3 p(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+            min = glm::min(min, p);
+            max = glm::max(max, p);
+        }
+
+        mesh.positionOffset = min;
+        mesh.positionScale = max - min;
+
+        for (uint i = first; i <= last; i++) {
+            for (uint j = 0; j < 3; j++) {
+                float extent = mesh.positionScale[j];
+                float value = extent == 0 ? 0 : (vertices[i * 3 + j] - min[j]) / extent;
+                data[i * 4 + j] = VertexQuantizer::toUnorm16(value);
+            }
+        }
+    }
+
+    stream.set(data, 3, GL_UNSIGNED_SHORT, true, 4 * sizeof(uint16));
+}
+
+void ShapeLoader::prepareBuffers() {
+    Geometry &geometry = m_shape->geometry;
+    Shape::VertexFormat &format = m_shape->vertexFormat;
+    Shape::Buffers &buffers = m_shape->buffers;
+
+    // createVAO limits max bones per vertex to 4
+    uint bonesCount = m_shape->bonesPerVertex < 4 ? m_shape->bonesPerVertex : 4;
+    bool quantize = hasParam(QuantizeVertices);
+
+    format = Shape::VertexFormat();
+    format.octahedral = quantize;
+    m_buffersData.clear();
+
+    for (Mesh &mesh : m_shape->meshes) {
+        mesh.positionOffset = glm::vec3(0.0f);
+        mesh.positionScale = glm::vec3(1.0f);
+    }
+
+    AttribStream streams[] = {
+        {{}, &format.vertices, &buffers.vertices},
+        {{}, &format.normals, &buffers.normals},
+        {{}, &format.texCoords, &buffers.texCoords},
+        {{}, &format.tangents, &buffers.tangents},
+        {{}, &format.bitangents, &buffers.bitangents},
+        {{}, &format.boneWeights, &buffers.boneWeights},
+        {{}, &format.boneIds, &buffers.boneIds}
+    };
+
+    AttribStream &vertices = streams[0], &normals = streams[1], &texCoords = streams[2],
+            &tangents = streams[3], &bitangents = streams[4], &boneWeights = streams[5], &boneIds = streams[6];
+
+    if (!geometry.vertices.empty()) {
+        if (quantize) {
+            quantizePositions(vertices, m_shape);
+        } else {
+            vertices.set(geometry.vertices, 3, GL_FLOAT, false, 3 * sizeof(float));
+        }
+    }
+
+    #define _direction(stream, src) \
+    if (!src.empty()) { \
+        if (quantize) \
+            quantizeOctahedral(stream, src); \
+        else \
+            stream.set(src, 3, GL_FLOAT, false, 3 * sizeof(float)); \
+    }
+
+    _direction(normals, geometry.normals)
+    _direction(tangents, geometry.tangents)
+    _direction(bitangents, geometry.bitangents)
+
+    #undef _direction
+
+    if (!geometry.texCoords.empty()) {
+        if (quantize) {
+            vector<uint16> data(geometry.texCoords.size());
+
+            for (usize i = 0; i < data.size(); i++)
+                data[i] = VertexQuantizer::toHalf(geometry.texCoords[i]);
+
+            texCoords.set(data, 2, GL_HALF_FLOAT, false, 2 * sizeof(uint16));
+        } else {
+            texCoords.set(geometry.texCoords, 2, GL_FLOAT, false, 2 * sizeof(float));
+        }
+    }
+
+    if (!geometry.boneWeights.empty() && hasParam(QuantizeBones)) {
+        // ubyte ids & unorm8 weights if ids fit, otherwise ushort ids & unorm16 weights
+        if (m_shape->bones.size() <= 256) {
+            quantizeBones<ubyte>(boneWeights, boneIds, geometry, m_shape->bonesPerVertex, bonesCount, GL_UNSIGNED_BYTE);
+        } else {
+            quantizeBones<uint16>(boneWeights, boneIds, geometry, m_shape->bonesPerVertex, bonesCount, GL_UNSIGNED_SHORT);
+        }
+    } else {
+        // bone streams contain `bonesPerVertex` components per vertex
+        if (!geometry.boneWeights.empty())
+            boneWeights.set(geometry.boneWeights, bonesCount, GL_FLOAT, false, m_shape->bonesPerVertex * sizeof(float));
+
+        if (!geometry.boneIds.empty())
+            boneIds.set(geometry.boneIds, bonesCount, GL_UNSIGNED_INT, false, m_shape->bonesPerVertex * sizeof(uint));
+    }
+
+    if (hasParam(InterleaveBuffers)) {
+        // each stream is copied to the interleaved vertex as is
+        for (AttribStream &stream : streams) {
+            if (stream.format->count != 0) {
+                stream.format->offset = format.stride;
+                format.stride += stream.format->size;
+            }
+        }
+
+        usize verticesCount = geometry.vertices.size() / 3;
+        vector<ubyte> data(format.stride * verticesCount);
+
+        for (const AttribStream &stream : streams) {
+            if (stream.format->count == 0)
+                continue;
+
+            uint size = stream.format->size;
+            ubyte *dst = data.data() + stream.format->offset;
+            usize count = std::min<usize>(verticesCount, stream.data.size() / size);
+
+            for (usize i = 0; i < count; i++)
+                memcpy(dst + i * format.stride, stream.data.data() + i * size, size);
+        }
+
+        m_buffersData.push_back({move(data), &buffers.interleaved, nullptr});
+    } else {
+        for (AttribStream &stream : streams) {
+            if (!stream.data.empty()) {
+                m_buffersData.push_back({move(stream.data), stream.buffer, nullptr});
+            }
+        }
+    }
+
+    prepareIndices();
+}
+
+void ShapeLoader::prepareIndices() {
+    Geometry &geometry = m_shape->geometry;
+
+    // indices are rebased to the first vertex of each mesh, so 16-bit indices
+    // can be used if each mesh references less than 65536 vertices.
+    // Lods use the same vertices, so they are covered by the mesh range
+    bool shortIndices = true;
+
+    for (Mesh &mesh : m_shape->meshes) {
+        if (mesh.count == 0) {
+            mesh.baseVertex = 0;
+            continue;
+        }
+
+        auto begin = geometry.indices.begin() + mesh.start;
+        auto range = minmax_element(begin, begin + mesh.count);
+        mesh.baseVertex = *range.first;
+
+        if (*range.second - *range.first > 0xffff)
+            shortIndices = false;
+    }
+
+    if (!shortIndices) {
+        for (Mesh &mesh : m_shape->meshes) {
+            mesh.indexType = GL_UNSIGNED_INT;
+            mesh.baseVertex = 0;
+        }
+
+        m_buffersData.push_back({toBytes(geometry.indices), nullptr, &m_shape->buffers.indices});
 
-    for (int i = 0; i < loadedTextures->size(); ++i)
-        if (loadedTextures->operator[](i).path == path && loadedTextures->operator[](i).params == params)
-            return i;
+        return;
+    }
+
+    vector<uint16> indices(geometry.indices.size());
+
+    for (Mesh &mesh : m_shape->meshes) {
+        mesh.indexType = GL_UNSIGNED_SHORT;
 
-    return -1;
+        for (uint level = 0; level <= mesh.lods.size(); level++) {
+            Mesh::Lod lod = mesh.getLod(level);
+
+            for (uint i = lod.start; i < lod.start + lod.count; i++) {
+                indices[i] = static_cast<uint16>(geometry.indices[i] - mesh.baseVertex);
+            }
+        }
+    }
+
+    m_buffersData.push_back({toBytes(indices), nullptr, &m_shape->buffers.indices});
 }
 
 ShapeLoader::ShapeLoader() {
@@ -392,7 +1081,7 @@ ShapeLoader::ShapeLoader() {
 
 #define ASSIMP_PARAMS_MAX_INDEX JoinIdenticalVertices
 #define isAssimpParam(param) param <= ASSIMP_PARAMS_MAX_INDEX
-void ShapeLoader::load() {
+bool ShapeLoader::loadScene() {
     uint assimpParams[] = {
             aiProcess_Triangulate,
             aiProcess_SortByPType,
@@ -410,34 +1099,45 @@ void ShapeLoader::load() {
 
     // Create an instance of the Importer class
     Assimp::Importer importer;
-    const aiScene *scene = importer.ReadFile(m_modelPath, completeAssimpParams);
+
+    // importer takes ownership of the IO system
+    if (m_assetPack != nullptr)
+        importer.SetIOHandler(new PackIOSystem(m_assetPack));
+
+    const aiScene *scene;
+
+    {
+        LoadStats::Scope scope(m_loadStats, LoadStats::AssimpImport);
+        scene = importer.ReadFile(m_modelPath, completeAssimpParams);
+    }
 
     // If the import failed, report it
     if (!scene) {
         std::cerr << "Assimp error: " << importer.GetErrorString() << "\n";
-        return;
+        return false;
     }
 
-    m_shape->globalInverseTransform = getMat4(scene->mRootNode->mTransformation);
-    m_shape->globalInverseTransform = glm::inverse(m_shape->globalInverseTransform);
+    {
+        LoadStats::Scope scope(m_loadStats, LoadStats::NodesAnimationsCopy);
 
-    m_shape->rootNode = Node(scene->mRootNode);
-    m_shape->animations.reserve(scene->mNumAnimations); // allocate space for animations
-    for (size_t i = 0; i < scene->mNumAnimations; i++)
-        m_shape->animations.emplace_back(scene->mAnimations[i]);
+        m_shape->globalInverseTransform = getMat4(scene->mRootNode->mTransformation);
+        m_shape->globalInverseTransform = glm::inverse(m_shape->globalInverseTransform);
 
-    std::string amtlPath = m_modelPath.substr(0, m_modelPath.find_last_of('.')) + ".amtl";
-    AMTLLoader amtl;
-    if (amtl.load(amtlPath))
-       m_amtlLoader = &amtl;
-    else {
-        // if load is called again and the AMTL file does not exist,
-        // while the previous load() AMTL existed, the pointer will
-        // point to the deleted memory
-        m_amtlLoader = nullptr;
+        m_shape->rootNode = Node(scene->mRootNode);
+        m_shape->animations.reserve(scene->mNumAnimations); // allocate space for animations
+        for (size_t i = 0; i < scene->mNumAnimations; i++)
+            m_shape->animations.emplace_back(scene->mAnimations[i]);
+    }
+
+    {
+        LoadStats::Scope scope(m_loadStats, LoadStats::ProcessNodes);
+
+        vector<const aiMesh*> aimeshes;
+        processNode(scene->mRootNode, scene, aimeshes);
+        processMeshes(aimeshes, scene);
     }
 
-    processNode(scene->mRootNode, scene);
+    LoadStats::Scope postProcessScope(m_loadStats, LoadStats::MeshPostProcess);
 
     // apply algine params
     for (const uint p : algineParams) {
@@ -446,17 +1146,340 @@ void ShapeLoader::load() {
                 for (float &normal : m_shape->geometry.normals)
                     normal *= -1;
                 break;
+            case OptimizeMeshes:
+                optimizeMeshes();
+                break;
+            case GenerateLods:
+            case BuildMeshlets:
+                break; // applied after other params
+            case QuantizeVertices:
+                break; // applied in prepareBuffers()
+            case InterleaveBuffers:
+                break; // applied in prepareBuffers()
+            case CompressTextures:
+                break; // applied in prepareTextures()
+            case QuantizeBones:
+                break; // applied in prepareBuffers()
             default:
                 std::cerr << "Unknown algine param " << p << "\n";
                 break;
         }
     }
 
+    // lods must be generated from the final geometry
+    if (hasParam(GenerateLods))
+        generateLods();
+
+    if (hasParam(BuildMeshlets))
+        buildMeshlets();
+
+    return true;
+}
+
+// remaps vertex stream of the vertices [first, first + remap.size())
+template<typename T>
+inline void remapStream(std::vector<T> &stream, const uint components, const uint first, const std::vector<uint> &remap) {
+    // stream can be absent or incomplete if meshes have different attributes
+    if (stream.size() >= (first + remap.size()) * components) {
+        MeshOptimizer::remapVertices(stream.data() + first * components, components, remap);
+    }
+}
+
+void ShapeLoader::optimizeMeshes() {
+    Geometry &geometry = m_shape->geometry;
+
+    for (const Mesh &mesh : m_shape->meshes) {
+        if (mesh.count == 0)
+            continue;
+
+        // each mesh has its own contiguous vertex range
+        uint *indices = &geometry.indices[mesh.start];
+        auto range = minmax_element(indices, indices + mesh.count);
+        uint first = *range.first;
+        uint verticesCount = *range.second - first + 1;
+
+        for (uint i = 0; i < mesh.count; i++)
+            indices[i] -= first;
+
+        MeshOptimizer::optimizeVertexCache(indices, mesh.count, verticesCount);
+        MeshOptimizer::optimizeOverdraw(indices, mesh.count, &geometry.vertices[first * 3], verticesCount);
+        vector<uint> remap = MeshOptimizer::optimizeVertexFetch(indices, mesh.count, verticesCount);
+
+        remapStream(geometry.vertices, 3, first, remap);
+        remapStream(geometry.normals, 3, first, remap);
+        remapStream(geometry.texCoords, 2, first, remap);
+        remapStream(geometry.tangents, 3, first, remap);
+        remapStream(geometry.bitangents, 3, first, remap);
+        remapStream(geometry.boneWeights, m_shape->bonesPerVertex, first, remap);
+        remapStream(geometry.boneIds, m_shape->bonesPerVertex, first, remap);
+
+        for (uint i = 0; i < mesh.count; i++)
+            indices[i] += first;
+    }
+}
+
+// each level halves triangles count of the mesh
+constexpr uint maxLodsCount = 4;
+
+// max allowed simplification error, relative to mesh size
+constexpr float maxLodError = 0.25f;
+
+void ShapeLoader::generateLods() {
+    Geometry &geometry = m_shape->geometry;
+
+    for (Mesh &mesh : m_shape->meshes) {
+        mesh.lods.clear();
+
+        if (mesh.count == 0)
+            continue;
+
+        vector<uint> indices(geometry.indices.begin() + mesh.start, geometry.indices.begin() + mesh.start + mesh.count);
+        auto range = minmax_element(indices.begin(), indices.end());
+        uint first = *range.first;
+        uint verticesCount = *range.second - first + 1;
+        const float *positions = &geometry.vertices[first * 3];
+
+        for (uint &index : indices)
+            index -= first;
+
+        // mesh size: half of the bounding box diagonal
+        glm::vec3 min(positions[0], positions[1], positions[2]), max = min;
+
+        for (uint i = 0; i < verticesCount; i++) {
+            glm::vec3 p(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+            min = glm::min(min, p);
+            max = glm::max(max, p);
+        }
+
+        float size = glm::length(max - min) * 0.5f;
+        usize previousCount = mesh.count;
+
+        for (uint level = 1; level <= maxLodsCount; level++) {
+            usize targetCount = mesh.count / 3 / (1u << level) * 3;
+            float error = 0;
+
+            vector<uint> lodIndices = MeshOptimizer::simplify(indices.data(), indices.size(), positions,
+                    verticesCount, targetCount, size * maxLodError, &error);
+
+            // simplification stuck, the next levels will be the same
+            if (lodIndices.empty() || lodIndices.size() > previousCount * 9 / 10)
+                break;
+
+            if (hasParam(OptimizeMeshes))
+                MeshOptimizer::optimizeVertexCache(lodIndices.data(), lodIndices.size(), verticesCount);
+
+            Mesh::Lod lod;
+            lod.start = geometry.indices.size();
+            lod.count = lodIndices.size();
+            lod.error = error;
+
+            for (const uint index : lodIndices)
+                geometry.indices.push_back(index + first);
+
+            mesh.lods.push_back(lod);
+            previousCount = lodIndices.size();
+        }
+    }
+
+    // per level errors of the whole shape
+    m_shape->lodErrors.clear();
+
+    for (const Mesh &mesh : m_shape->meshes) {
+        if (mesh.lods.size() + 1 > m_shape->lodErrors.size())
+            m_shape->lodErrors.resize(mesh.lods.size() + 1, 0.0f);
+    }
+
+    for (uint level = 1; level < m_shape->lodErrors.size(); level++) {
+        for (const Mesh &mesh : m_shape->meshes) {
+            m_shape->lodErrors[level] = std::max(m_shape->lodErrors[level], mesh.getLod(level).error);
+        }
+    }
+}
+
+void ShapeLoader::buildMeshlets() {
+    Geometry &geometry = m_shape->geometry;
+
+    m_shape->meshlets.clear();
+
+    // meshlet bounds are computed for the bind pose, so they are invalid for skinned shapes
+    if (m_shape->bonesPerVertex != 0)
+        return;
+
+    for (Mesh &mesh : m_shape->meshes) {
+        mesh.meshletsStart = m_shape->meshlets.size();
+        mesh.meshletsCount = 0;
+
+        if (mesh.count == 0)
+            continue;
+
+        vector<Meshlet> meshlets = MeshOptimizer::buildMeshlets(&geometry.indices[mesh.start], mesh.count,
+                geometry.vertices.data());
+
+        for (Meshlet &meshlet : meshlets)
+            meshlet.start += mesh.start;
+
+        mesh.meshletsCount = meshlets.size();
+        m_shape->meshlets.insert(m_shape->meshlets.end(), meshlets.begin(), meshlets.end());
+    }
+}
+
+void ShapeLoader::computeBoundingSphere() {
+    const vector<float> &vertices = m_shape->geometry.vertices;
+
+    m_shape->boundingCenter = glm::vec3(0.0f);
+    m_shape->boundingRadius = 0;
+
+    if (vertices.empty())
+        return;
+
+    glm::vec3 min(vertices[0], vertices[1], vertices[2]), max = min;
+
+    for (usize i = 0; i < vertices.size(); i += 3) {
+        glm::vec3 p(vertices[i], vertices[i + 1], vertices[i + 2]);
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    m_shape->boundingCenter = (min + max) * 0.5f;
+
+    for (usize i = 0; i < vertices.size(); i += 3) {
+        glm::vec3 p(vertices[i], vertices[i + 1], vertices[i + 2]);
+        m_shape->boundingRadius = std::max(m_shape->boundingRadius, glm::length(p - m_shape->boundingCenter));
+    }
+}
+
+bool ShapeLoader::hasParam(const uint param) const {
+    return find(m_params.begin(), m_params.end(), param) != m_params.end();
+}
+
+bool ShapeLoader::prepare() {
+    std::string amtlPath = m_modelPath.substr(0, m_modelPath.find_last_of('.')) + ".amtl";
+    AMTLLoader amtl;
+    bool amtlLoaded;
+
+    {
+        LoadStats::Scope scope(m_loadStats, LoadStats::AMTLParse);
+        amtlLoaded = m_assetPack != nullptr ?
+                m_assetPack->exists(amtlPath) && amtl.load(*m_assetPack, amtlPath) : amtl.load(amtlPath);
+    }
+
+    if (amtlLoaded)
+       m_amtlLoader = &amtl;
+    else {
+        // if load is called again and the AMTL file does not exist,
+        // while the previous load() AMTL existed, the pointer will
+        // point to the deleted memory
+        m_amtlLoader = nullptr;
+    }
+
+    bool cacheLoaded = false;
+
+    if (!m_cachePath.empty()) {
+        LoadStats::Scope scope(m_loadStats, LoadStats::CacheLoad);
+        cacheLoaded = ShapeCache::load(m_cachePath, *this);
+    }
+
+    // AMTL is still needed if shape was loaded from cache: it contains texture params
+    if (!cacheLoaded) {
+        if (!loadScene()) {
+            m_amtlLoader = nullptr;
+            return false;
+        }
+
+        if (!m_cachePath.empty()) {
+            LoadStats::Scope scope(m_loadStats, LoadStats::CacheSave);
+            ShapeCache::save(m_cachePath, *this);
+        }
+    }
+
+    computeBoundingSphere();
+    m_shape->skeleton.build(m_shape->rootNode, m_shape->bones, m_shape->animations);
+
     // load textures
-    loadTextures();
+    {
+        LoadStats::Scope scope(m_loadStats, LoadStats::TexturesDecode);
+        prepareTextures();
+        m_amtlLoader = nullptr;
+    }
 
     // generate buffers
-    genBuffers();
+    {
+        LoadStats::Scope scope(m_loadStats, LoadStats::BuffersPrepare);
+        prepareBuffers();
+
+        // buffers data is already copied to m_buffersData
+        releaseGeometry();
+    }
+
+    return true;
+}
+
+void ShapeLoader::releaseGeometry() {
+    Geometry &geometry = m_shape->geometry;
+    m_releasedGeometrySize = getGeometrySavings(geometry, m_geometryRetention);
+
+    if (m_geometryRetention == KeepAllGeometry)
+        return;
+
+    releaseVector(geometry.normals);
+    releaseVector(geometry.texCoords);
+    releaseVector(geometry.tangents);
+    releaseVector(geometry.bitangents);
+    releaseVector(geometry.boneWeights);
+    releaseVector(geometry.boneIds);
+
+    if (m_geometryRetention == ReleaseGeometry) {
+        releaseVector(geometry.vertices);
+        releaseVector(geometry.indices);
+    }
+}
+
+void ShapeLoader::finishUpload() {
+    m_pendingTextures.clear();
+    m_images.clear();
+    m_mipmaps.clear();
+    m_compressedImages.clear();
+    m_buffersData.clear();
+}
+
+void ShapeLoader::load() {
+    if (!prepare())
+        return;
+
+    for (const PendingTexture &pendingTexture : m_pendingTextures)
+        uploadTexture(pendingTexture);
+
+    for (const BufferData &bufferData : m_buffersData)
+        uploadBuffer(bufferData);
+
+    finishUpload();
+}
+
+future<bool> ShapeLoader::loadAsync(GLUploadQueue *uploadQueue) {
+    auto promise = make_shared<std::promise<bool>>();
+    future<bool> result = promise->get_future();
+
+    ThreadPool::getDefault()->submit([this, uploadQueue, promise]() {
+        if (!prepare()) {
+            promise->set_value(false);
+            return;
+        }
+
+        // each texture & buffer is a separate upload task, so uploading
+        // can be spread over several frames
+        for (usize i = 0; i < m_pendingTextures.size(); i++)
+            uploadQueue->push([this, i]() { uploadTexture(m_pendingTextures[i]); });
+
+        for (usize i = 0; i < m_buffersData.size(); i++)
+            uploadQueue->push([this, i]() { uploadBuffer(m_buffersData[i]); });
+
+        uploadQueue->push([this, promise]() {
+            finishUpload();
+            promise->set_value(true);
+        });
+    });
+
+    return result;
 }
 
 void ShapeLoader::addParam(uint param) {
@@ -471,10 +1494,49 @@ void ShapeLoader::setTexturesPath(const std::string &path) {
     m_texturesPath = path;
 }
 
+void ShapeLoader::setCachePath(const std::string &path) {
+    m_cachePath = path;
+}
+
+void ShapeLoader::setTexturesCachePath(const std::string &path) {
+    m_texturesCachePath = path;
+}
+
 void ShapeLoader::setDefaultTexturesParams(const std::map<uint, uint> &params) {
     m_defaultTexturesParams = params;
 }
 
+void ShapeLoader::setLoadStats(LoadStats *stats) {
+    m_loadStats = stats;
+}
+
+void ShapeLoader::setAssetPack(const AssetPack *pack) {
+    m_assetPack = pack;
+}
+
+void ShapeLoader::setGeometryHeap(GeometryHeap *heap) {
+    m_geometryHeap = heap;
+}
+
+void ShapeLoader::setGeometryRetention(const uint retention) {
+    m_geometryRetention = retention;
+}
+
+usize ShapeLoader::getReleasedGeometrySize() const {
+    return m_releasedGeometrySize;
+}
+
+usize ShapeLoader::getGeometrySavings(const Geometry &geometry, const uint retention) {
+    switch (retention) {
+        case KeepPositionsIndices:
+            return geometry.getSize() - getVectorSize(geometry.vertices) - getVectorSize(geometry.indices);
+        case ReleaseGeometry:
+            return geometry.getSize();
+        default:
+            return 0;
+    }
+}
+
 Shape *ShapeLoader::getShape() const {
     return m_shape;
 }
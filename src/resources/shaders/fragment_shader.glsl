@@ -28,6 +28,7 @@ in vec2 texCoord; // Texture coordinates.
 
 uniform struct Material {
 	sampler2D normal; // normal mapping sampler
+	bool normalRG; // two channel (BC5) normal map, z is reconstructed
 	
 	sampler2D reflectionStrength; // ssr samplers
 	sampler2D jitter;
@@ -170,6 +171,16 @@ float calculateAttenuation(float kc, float kl, float kq) {
 
 #define toVec4(v) vec4(v, 1.0)
 
+// tangent space normal from the normal map
+vec3 getMapNormal() {
+	if (material.normalRG) {
+		vec2 xy = texture2D(material.normal, texCoord).rg * 2.0 - 1.0; // from [0; 1] to [-1; 1]
+		return vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
+	}
+
+	return normalize(texture2D(material.normal, texCoord).rgb * 2.0 - 1.0); // from [0; 1] to [-1; 1]
+}
+
 // kclq: vec3(kc, kl, kq)
 void calculateBaseLighting(vec3 pos, vec3 color, float kc, float kl, float kq) {
 	lampEyePos = vec3(viewMatrix * toVec4(pos));
@@ -201,13 +212,11 @@ void main() {
 	#ifdef ALGINE_NORMAL_MAPPING_MODE_DUAL
 	if (u_NormalMapping == 0) norm = viewNormal;
 	else { // using normal map if normal mapping enabled
-		norm = texture2D(material.normal, texCoord).rgb;
-		norm = normalize(norm * 2.0 - 1.0); // from [0; 1] to [-1; 1]
+		norm = getMapNormal();
 		norm = normalize(v_TBN * norm);
 	}
 	#elif defined ALGINE_NORMAL_MAPPING_MODE_ENABLED
-	norm = texture2D(material.normal, texCoord).rgb;
-	norm = normalize(norm * 2.0 - 1.0); // from [0; 1] to [-1; 1]
+	norm = getMapNormal();
 	norm = normalize(v_TBN * norm);
 	#else
 	norm = viewNormal;
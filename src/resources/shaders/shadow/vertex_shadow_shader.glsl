@@ -14,24 +14,76 @@ in vec4 a_Position;
 // if dif light transformationMatrix = lightSpaceMatrix * modelMatrix
 // if point light transformationMatrix = modelMatrix
 uniform mat4 transformationMatrix;
-uniform mat4 bones[MAX_BONES];
+uniform samplerBuffer bones; // palettes of all models, 4 texels per matrix or 2 per dual quaternion
+uniform int boneOffset = 0; // first matrix of the model palette
 uniform int boneAttribsPerVertex = 0;
+uniform vec3 positionOffset = vec3(0.0); // position dequantization: position * positionScale + positionOffset
+uniform vec3 positionScale = vec3(1.0);
+
+#ifdef ALGINE_DQ_SKINNING
+// dual quaternions are packed two per matrix, see Animator::DualQuaternionSkinning
+void addBone(int index, float weight, vec4 pivot, inout vec4 real, inout vec4 dual) {
+    int texel = boneOffset * 4 + index * 2;
+    vec4 boneReal = texelFetch(bones, texel);
+    vec4 boneDual = texelFetch(bones, texel + 1);
+
+    // q and -q are the same rotation, so blending is done in the same hemisphere
+    if (dot(boneReal, pivot) < 0.0)
+        weight = -weight;
+
+    real += boneReal * weight;
+    dual += boneDual * weight;
+}
+
+vec3 dqRotate(vec4 real, vec3 v) {
+    return v + 2.0 * cross(real.xyz, cross(real.xyz, v) + real.w * v);
+}
+
+vec3 dqTranslation(vec4 real, vec4 dual) {
+    return 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+}
+#else
+mat4 getBone(int index) {
+    int texel = (boneOffset + index) * 4;
+    return mat4(texelFetch(bones, texel), texelFetch(bones, texel + 1),
+                texelFetch(bones, texel + 2), texelFetch(bones, texel + 3));
+}
+#endif
 
 void main() {
-	vec4 position = a_Position;
+	vec4 position = vec4(a_Position.xyz * positionScale + positionOffset, 1.0);
 
 	#ifdef ALGINE_BONE_SYSTEM_ENABLED
+    #ifdef ALGINE_DQ_SKINNING
+    if (boneAttribsPerVertex != 0) {
+        vec4 real = vec4(0.0), dual = vec4(0.0);
+        vec4 pivot = texelFetch(bones, boneOffset * 4 + a_BoneIds[0].x * 2);
+        for (int i = 0; i < boneAttribsPerVertex; i++) {
+            addBone(a_BoneIds[i].x, a_BoneWeights[i].x, pivot, real, dual);
+            addBone(a_BoneIds[i].y, a_BoneWeights[i].y, pivot, real, dual);
+            addBone(a_BoneIds[i].z, a_BoneWeights[i].z, pivot, real, dual);
+            addBone(a_BoneIds[i].w, a_BoneWeights[i].w, pivot, real, dual);
+        }
+
+        float len = length(real);
+        real /= len;
+        dual /= len;
+
+        position.xyz = dqRotate(real, position.xyz) + dqTranslation(real, dual);
+    }
+    #else
     if (boneAttribsPerVertex != 0) {
         mat4 finalTransform = mat4(0.0);
         for (int i = 0; i < boneAttribsPerVertex; i++) {
-            finalTransform += bones[a_BoneIds[i].x] * a_BoneWeights[i].x;
-            finalTransform += bones[a_BoneIds[i].y] * a_BoneWeights[i].y;
-            finalTransform += bones[a_BoneIds[i].z] * a_BoneWeights[i].z;
-            finalTransform += bones[a_BoneIds[i].w] * a_BoneWeights[i].w;
+            finalTransform += getBone(a_BoneIds[i].x) * a_BoneWeights[i].x;
+            finalTransform += getBone(a_BoneIds[i].y) * a_BoneWeights[i].y;
+            finalTransform += getBone(a_BoneIds[i].z) * a_BoneWeights[i].z;
+            finalTransform += getBone(a_BoneIds[i].w) * a_BoneWeights[i].w;
         }
 
         position = finalTransform * position;
     }
+    #endif
     #endif
 
 	gl_Position = transformationMatrix * position;
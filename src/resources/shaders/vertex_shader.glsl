@@ -10,14 +10,18 @@
 #version 330
 
 uniform mat4 MVPMatrix, modelMatrix, viewMatrix, MVMatrix;
-uniform mat4 bones[MAX_BONES];
+uniform samplerBuffer bones; // palettes of all models, 4 texels per matrix or 2 per dual quaternion
+uniform int boneOffset = 0; // first matrix of the model palette
 uniform bool u_NormalMapping;
 uniform int boneAttribsPerVertex = 0;
+uniform vec3 positionOffset = vec3(0.0); // position dequantization: position * positionScale + positionOffset
+uniform vec3 positionScale = vec3(1.0);
+uniform bool octahedralNormals = false; // normals, tangents and bitangents are octahedral encoded
 
 in vec4 inPos; // Per-vertex position information we will pass in.
 in vec4 inBoneWeights[MAX_BONE_ATTRIBS_PER_VERTEX];
 in ivec4 inBoneIds[MAX_BONE_ATTRIBS_PER_VERTEX];
-in vec3 inNormal;
+in vec3 inNormal; // or vec2 if octahedral encoded
 in vec3 inTangent;
 in vec3 inBitangent;
 in vec2 inTexCoord; // Per-vertex texture information we will pass in.
@@ -28,28 +32,93 @@ out vec3 viewNormal;
 out vec3 viewPosition;
 out vec2 texCoord;
 
-#define TBN mat3(normalize(vec3(MVMatrix * vec4(inTangent, 0.0))), \
-				 normalize(vec3(MVMatrix * vec4(inBitangent, 0.0))), \
+#define TBN mat3(normalize(vec3(MVMatrix * vec4(tangent, 0.0))), \
+				 normalize(vec3(MVMatrix * vec4(bitangent, 0.0))), \
 				 normalize(vec3(MVMatrix * vec4(normal, 0.0))))
 
+vec3 octahedralDecode(vec2 e) {
+    vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (v.z < 0.0)
+        v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+    return normalize(v);
+}
+
+#ifdef ALGINE_DQ_SKINNING
+// dual quaternions are packed two per matrix, see Animator::DualQuaternionSkinning
+void addBone(int index, float weight, vec4 pivot, inout vec4 real, inout vec4 dual) {
+    int texel = boneOffset * 4 + index * 2;
+    vec4 boneReal = texelFetch(bones, texel);
+    vec4 boneDual = texelFetch(bones, texel + 1);
+
+    // q and -q are the same rotation, so blending is done in the same hemisphere
+    if (dot(boneReal, pivot) < 0.0)
+        weight = -weight;
+
+    real += boneReal * weight;
+    dual += boneDual * weight;
+}
+
+vec3 dqRotate(vec4 real, vec3 v) {
+    return v + 2.0 * cross(real.xyz, cross(real.xyz, v) + real.w * v);
+}
+
+vec3 dqTranslation(vec4 real, vec4 dual) {
+    return 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+}
+#else
+mat4 getBone(int index) {
+    int texel = (boneOffset + index) * 4;
+    return mat4(texelFetch(bones, texel), texelFetch(bones, texel + 1),
+                texelFetch(bones, texel + 2), texelFetch(bones, texel + 3));
+}
+#endif
+
 void main() {
-    vec4 position = inPos;
+    vec4 position = vec4(inPos.xyz * positionScale + positionOffset, 1.0);
     vec3 normal = inNormal;
+    vec3 tangent = inTangent;
+    vec3 bitangent = inBitangent;
+
+    if (octahedralNormals) {
+        normal = octahedralDecode(inNormal.xy);
+        tangent = octahedralDecode(inTangent.xy);
+        bitangent = octahedralDecode(inBitangent.xy);
+    }
 
     #ifdef ALGINE_BONE_SYSTEM_ENABLED
+    #ifdef ALGINE_DQ_SKINNING
+    if (boneAttribsPerVertex != 0) {
+        vec4 real = vec4(0.0), dual = vec4(0.0);
+        vec4 pivot = texelFetch(bones, boneOffset * 4 + inBoneIds[0].x * 2);
+        for (int i = 0; i < boneAttribsPerVertex; i++) {
+            addBone(inBoneIds[i].x, inBoneWeights[i].x, pivot, real, dual);
+            addBone(inBoneIds[i].y, inBoneWeights[i].y, pivot, real, dual);
+            addBone(inBoneIds[i].z, inBoneWeights[i].z, pivot, real, dual);
+            addBone(inBoneIds[i].w, inBoneWeights[i].w, pivot, real, dual);
+        }
+
+        float len = length(real);
+        real /= len;
+        dual /= len;
+
+        position.xyz = dqRotate(real, position.xyz) + dqTranslation(real, dual);
+        normal = dqRotate(real, normal);
+    }
+    #else
     if (boneAttribsPerVertex != 0) {
         mat4 finalTransform = mat4(0.0);
         for (int i = 0; i < boneAttribsPerVertex; i++) {
-            finalTransform += bones[inBoneIds[i].x] * inBoneWeights[i].x;
-            finalTransform += bones[inBoneIds[i].y] * inBoneWeights[i].y;
-            finalTransform += bones[inBoneIds[i].z] * inBoneWeights[i].z;
-            finalTransform += bones[inBoneIds[i].w] * inBoneWeights[i].w;
+            finalTransform += getBone(inBoneIds[i].x) * inBoneWeights[i].x;
+            finalTransform += getBone(inBoneIds[i].y) * inBoneWeights[i].y;
+            finalTransform += getBone(inBoneIds[i].z) * inBoneWeights[i].z;
+            finalTransform += getBone(inBoneIds[i].w) * inBoneWeights[i].w;
         }
 
         position = finalTransform * position;
         normal = mat3(finalTransform) * normal;
     }
     #endif
+    #endif
 
     // gl_Position is a special variable used to store the final position.
     // Multiply the vertex by the matrix to get the final point in normalized screen coordinates.
@@ -193,23 +193,19 @@ uint Texture::getId() const {
 }
 
 void Texture::texFromFile(const std::string &path, uint _target, uint dataType, bool flipImage) {
-    int channels;
-    stbi_set_flip_vertically_on_load(flipImage);
-    unsigned char *data = stbi_load(path.c_str(),
-                                    reinterpret_cast<int *>(&width), reinterpret_cast<int *>(&height), &channels, 0);
+    Image image;
+    if (!image.fromFile(path, flipImage))
+        return;
 
-    int formats[] = {Red, RG, RGB, RGBA};
-    int dataFormat = formats[channels - 1];
+    texFromImage(image, _target, dataType);
+}
 
-    if (data) {
-        glTexImage2D(_target, lod, format, width, height, 0, dataFormat, dataType, data);
-        glGenerateMipmap(target);
-    } else {
-        std::cerr << "Failed to load texture " << path << std::endl;
-        return;
-    }
+void Texture::texFromImage(const Image &image, uint _target, uint dataType) {
+    width = image.width;
+    height = image.height;
 
-    stbi_image_free(data);
+    glTexImage2D(_target, lod, format, width, height, 0, image.getDataFormat(), dataType, image.data);
+    glGenerateMipmap(target);
 }
 
 Texture2D::Texture2D(): Texture(GL_TEXTURE_2D) {}
@@ -218,6 +214,73 @@ void Texture2D::fromFile(const std::string &path, const uint dataType, const boo
     texFromFile(path, GL_TEXTURE_2D, dataType, flipImage);
 }
 
+void Texture2D::fromPack(const AssetPack &pack, const std::string &name, const uint dataType, const bool flipImage) {
+    Image image;
+    if (!image.fromPack(pack, name, flipImage))
+        return;
+
+    texFromImage(image, GL_TEXTURE_2D, dataType);
+}
+
+void Texture2D::fromImage(const Image &image, const uint dataType) {
+    texFromImage(image, GL_TEXTURE_2D, dataType);
+}
+
+void Texture2D::fromImage(const Image &image, const vector<MipmapGenerator::Level> &mipmaps) {
+    width = image.width;
+    height = image.height;
+
+    uint dataFormat = image.getDataFormat();
+    auto levelsCount = static_cast<GLsizei>(mipmaps.size() + 1);
+
+    // rows of 1 and 3 channels images may be not 4 bytes aligned
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (GLEW_ARB_texture_storage) {
+        glTexStorage2D(target, levelsCount, format, width, height);
+        glTexSubImage2D(target, 0, 0, 0, width, height, dataFormat, GL_UNSIGNED_BYTE, image.data);
+
+        for (uint i = 0; i < mipmaps.size(); i++)
+            glTexSubImage2D(target, i + 1, 0, 0, mipmaps[i].width, mipmaps[i].height, dataFormat,
+                    GL_UNSIGNED_BYTE, mipmaps[i].data.data());
+    } else {
+        glTexImage2D(target, 0, format, width, height, 0, dataFormat, GL_UNSIGNED_BYTE, image.data);
+
+        for (uint i = 0; i < mipmaps.size(); i++)
+            glTexImage2D(target, i + 1, format, mipmaps[i].width, mipmaps[i].height, 0, dataFormat,
+                    GL_UNSIGNED_BYTE, mipmaps[i].data.data());
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levelsCount - 1);
+}
+
+void Texture2D::fromCompressedImage(const CompressedImage &image) {
+    if (image.levels.empty())
+        return;
+
+    format = image.format;
+    width = image.levels[0].width;
+    height = image.levels[0].height;
+
+    auto levelsCount = static_cast<GLsizei>(image.levels.size());
+
+    if (GLEW_ARB_texture_storage)
+        glTexStorage2D(target, levelsCount, format, width, height);
+
+    for (uint i = 0; i < image.levels.size(); i++) {
+        const CompressedImage::Level &level = image.levels[i];
+        auto size = static_cast<GLsizei>(level.data.size());
+
+        if (GLEW_ARB_texture_storage)
+            glCompressedTexSubImage2D(target, i, 0, 0, level.width, level.height, format, size, level.data.data());
+        else
+            glCompressedTexImage2D(target, i, format, level.width, level.height, 0, size, level.data.data());
+    }
+
+    glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levelsCount - 1);
+}
+
 // GL_INVALID_OPERATION is generated if internalformat is GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT16,
 // GL_DEPTH_COMPONENT24, or GL_DEPTH_COMPONENT32F, and format is not GL_DEPTH_COMPONENT
 // https://www.khronos.org/registry/OpenGL-Refpages/gl4/html/glTexImage2D.xhtml
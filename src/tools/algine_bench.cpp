@@ -0,0 +1,308 @@
+/**
+ * Measures ShapeLoader stages, see LoadStats.
+ * Usage:
+ *   algine_bench [--no-gl] [--cache] [--iterations N] [--output results.json] <model>...
+ * --no-gl: headless, only CPU stages are executed
+ * --cache: enables shape & compressed textures caches, otherwise each load is cold
+ * Results are written as JSON: each run and the median of each stage per model
+ */
+
+#include <algine/model.h>
+#include <algine/TextureCache.h>
+#include <algine/LoadStats.h>
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+using namespace algine;
+using namespace std;
+
+/* --- allocations counting --- */
+
+atomic<uint64> allocationsCount(0), allocatedBytes(0);
+
+void* operator new(size_t size) {
+    allocationsCount.fetch_add(1, memory_order_relaxed);
+    allocatedBytes.fetch_add(size, memory_order_relaxed);
+
+    if (void *ptr = malloc(size != 0 ? size : 1))
+        return ptr;
+
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+    free(ptr);
+}
+
+LoadStats::AllocationsInfo countAllocations() {
+    LoadStats::AllocationsInfo info;
+    info.allocations = allocationsCount.load(memory_order_relaxed);
+    info.allocatedBytes = allocatedBytes.load(memory_order_relaxed);
+    return info;
+}
+
+/* --- benchmark --- */
+
+// gives access to the CPU stage, so models can be loaded without GL
+class BenchShapeLoader: public ShapeLoader {
+public:
+    using ShapeLoader::prepare;
+    using ShapeLoader::finishUpload;
+};
+
+struct Options {
+    bool gl = true, cache = false;
+    uint iterations = 5;
+    string output = "bench_results.json";
+    vector<string> models;
+};
+
+void printUsage() {
+    cout << "Usage: algine_bench [--no-gl] [--cache] [--iterations N] [--output results.json] <model>...\n";
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+
+        if (arg == "--no-gl") {
+            options.gl = false;
+        } else if (arg == "--cache") {
+            options.cache = true;
+        } else if (arg == "--iterations" && i + 1 < argc) {
+            options.iterations = max(atoi(argv[++i]), 1);
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            options.models.push_back(arg);
+        }
+    }
+
+    return !options.models.empty();
+}
+
+// hidden window: GL context is required for uploads
+GLFWwindow* createContext() {
+    if (!glfwInit()) {
+        cerr << "GLFW init failed\n";
+        return nullptr;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "algine_bench", nullptr, nullptr);
+
+    if (window == nullptr) {
+        cerr << "Can't create GL context, use --no-gl for headless run\n";
+        glfwTerminate();
+        return nullptr;
+    }
+
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+
+    if (glewInit() != GLEW_NO_ERROR) {
+        cerr << "GLEW init failed\n";
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return nullptr;
+    }
+
+    return window;
+}
+
+// creates directory if it doesn't exist, parent directory must exist
+inline void makeDirectory(const string &path) {
+#ifdef _WIN32
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+}
+
+// loads model once, returns false on failure
+bool run(const Options &options, const string &model, LoadStats &stats) {
+    BenchShapeLoader loader;
+    loader.setModelPath(model);
+    loader.addParams(ShapeLoader::Triangulate, ShapeLoader::SortByPolygonType,
+            ShapeLoader::CalcTangentSpace, ShapeLoader::JoinIdenticalVertices, ShapeLoader::OptimizeMeshes,
+            ShapeLoader::GenerateLods, ShapeLoader::BuildMeshlets,
+            ShapeLoader::QuantizeVertices, ShapeLoader::InterleaveBuffers, ShapeLoader::CompressTextures,
+            ShapeLoader::QuantizeBones);
+
+    if (options.cache) {
+        loader.setCachePath(model + ".cache");
+        loader.setTexturesCachePath("cache/textures"); // the same as in the demo
+    }
+
+    loader.setLoadStats(&stats);
+
+    bool loaded;
+
+    if (options.gl) {
+        loader.load();
+        loaded = !loader.getShape()->meshes.empty();
+    } else {
+        loaded = loader.prepare();
+        loader.finishUpload();
+    }
+
+    Shape *shape = loader.getShape();
+
+    if (options.gl)
+        shape->recycle();
+
+    delete shape;
+
+    // textures must be loaded again by the next run
+    TextureCache::getDefault()->clear();
+
+    return loaded;
+}
+
+nlohmann::json toJSON(const LoadStats::Stage &stage) {
+    nlohmann::json json;
+    json["time_ms"] = stage.time;
+    json["allocations"] = stage.allocations;
+    json["allocated_bytes"] = stage.allocatedBytes;
+    json["calls"] = stage.calls;
+    return json;
+}
+
+template<typename T>
+T median(vector<T> values) {
+    sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+int main(int argc, char **argv) {
+    Options options;
+
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    GLFWwindow *window = nullptr;
+
+    if (options.gl && (window = createContext()) == nullptr)
+        return 1;
+
+    if (options.cache) {
+        makeDirectory("cache");
+        makeDirectory("cache/textures");
+    }
+
+    LoadStats::allocationsCounter = countAllocations;
+
+    nlohmann::json results;
+    results["iterations"] = options.iterations;
+    results["gl"] = options.gl;
+    results["cache"] = options.cache;
+    results["models"] = nlohmann::json::array();
+
+    for (const string &model : options.models) {
+        vector<LoadStats> runs(options.iterations);
+        nlohmann::json modelJSON;
+        modelJSON["path"] = model;
+        modelJSON["runs"] = nlohmann::json::array();
+
+        for (LoadStats &stats : runs) {
+            if (!run(options, model, stats)) {
+                cerr << "Can't load " << model << "\n";
+                return 1;
+            }
+
+            nlohmann::json runJSON;
+            runJSON["total_ms"] = stats.getTotalTime();
+
+            for (uint stage = 0; stage < LoadStats::StagesCount; stage++)
+                runJSON["stages"][LoadStats::getStageName(stage)] = toJSON(stats.get(stage));
+
+            modelJSON["runs"].push_back(runJSON);
+        }
+
+        // medians are more stable than means with the cold first run
+        cout << model << ":\n";
+
+        vector<double> totals;
+
+        for (const LoadStats &stats : runs)
+            totals.push_back(stats.getTotalTime());
+
+        modelJSON["median"]["total_ms"] = median(totals);
+
+        for (uint stage = 0; stage < LoadStats::StagesCount; stage++) {
+            vector<double> times;
+            vector<uint64> allocations, bytes;
+
+            for (const LoadStats &stats : runs) {
+                times.push_back(stats.get(stage).time);
+                allocations.push_back(stats.get(stage).allocations);
+                bytes.push_back(stats.get(stage).allocatedBytes);
+            }
+
+            nlohmann::json &stageJSON = modelJSON["median"]["stages"][LoadStats::getStageName(stage)];
+            stageJSON["time_ms"] = median(times);
+            stageJSON["allocations"] = median(allocations);
+            stageJSON["allocated_bytes"] = median(bytes);
+
+            cout << "  " << LoadStats::getStageName(stage) << ": " << median(times) << " ms, "
+                 << median(allocations) << " allocations, " << median(bytes) << " bytes\n";
+        }
+
+        cout << "  total: " << median(totals) << " ms\n";
+
+        results["models"].push_back(modelJSON);
+    }
+
+    ofstream out(options.output);
+
+    if (!out.is_open()) {
+        cerr << "Can't open " << options.output << " for writing\n";
+        return 1;
+    }
+
+    out << results.dump(4) << "\n";
+
+    if (window != nullptr) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * Cooks assets into the pack file, see AssetPack.
+ * Usage:
+ *   algine_pack [--lz4] <output.pack> <file | @list>...
+ *   algine_pack --list <input.pack>
+ * @list is a text file with one path per line. Entry names are the given
+ * paths, so assets are requested from the pack by the same paths as from the disk
+ */
+
+#include <algine/AssetPack.h>
+#include <algine/AssetPackWriter.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace algine;
+using namespace std;
+
+void printUsage() {
+    cout << "Usage:\n"
+            "  algine_pack [--lz4] <output.pack> <file | @list>...\n"
+            "  algine_pack --list <input.pack>\n";
+}
+
+int listPack(const string &path) {
+    AssetPack pack;
+
+    if (!pack.open(path))
+        return 1;
+
+    for (const string &name : pack.getNames()) {
+        const AssetPack::Entry *entry = pack.getEntry(name);
+        cout << name << ": " << entry->size << " bytes";
+
+        if (entry->flags & AssetPack::Compressed)
+            cout << ", lz4 " << entry->storedSize << " bytes";
+
+        cout << "\n";
+    }
+
+    return 0;
+}
+
+// expands @list arguments
+bool collectPaths(const vector<string> &args, vector<string> &paths) {
+    for (const string &arg : args) {
+        if (arg.empty() || arg[0] != '@') {
+            paths.push_back(arg);
+            continue;
+        }
+
+        ifstream list(arg.substr(1));
+
+        if (!list.is_open()) {
+            cerr << "Can't open list " << arg.substr(1) << "\n";
+            return false;
+        }
+
+        string line;
+
+        while (getline(list, line)) {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+
+            if (!line.empty())
+                paths.push_back(line);
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    vector<string> args(argv + 1, argv + argc);
+    bool compress = false;
+
+    if (args.size() == 2 && args[0] == "--list")
+        return listPack(args[1]);
+
+    if (!args.empty() && args[0] == "--lz4") {
+        compress = true;
+        args.erase(args.begin());
+    }
+
+    if (args.size() < 2) {
+        printUsage();
+        return 1;
+    }
+
+    string output = args[0];
+    vector<string> paths;
+
+    if (!collectPaths(vector<string>(args.begin() + 1, args.end()), paths))
+        return 1;
+
+    AssetPackWriter writer;
+
+    for (const string &path : paths) {
+        if (!writer.addFile(path, compress))
+            return 1;
+    }
+
+    if (!writer.save(output))
+        return 1;
+
+    cout << paths.size() << " files, " << writer.getSize() << " bytes packed to " << output
+         << " (" << writer.getStoredSize() << " bytes stored)\n";
+
+    return 0;
+}